@@ -6,25 +6,70 @@
 #include "PoolSubsystem.h"
 #include "Components/AudioComponent.h"
 #include "GameFramework/Actor.h"
-#include "GameFramework/ProjectileMovementComponent.h"
+#include "GameFramework/MovementComponent.h"
+#include "HAL/PlatformTime.h"
+#include "TimerManager.h"
 #include "Particles/ParticleSystemComponent.h"
 
-const FDefaultComponentValues& FDefaultComponentsValuesContainer::FindComponent(UActorComponent* InComponent)
+int32 FDefaultComponentsValuesContainer::FindComponentIndex(FName ComponentName) const
 {
-	FDefaultComponentValues* FoundItem = ComponentValues.FindByPredicate([InComponent](const FDefaultComponentValues& Item) { return Item.Component == InComponent; });
+	const int32* FoundIndex = ComponentIndexByName.Find(ComponentName);
+	return FoundIndex ? *FoundIndex : INDEX_NONE;
+}
+
+void FDefaultComponentsValuesContainer::Add(const FDefaultComponentValues& InComponentValues)
+{
+	const int32 Index = ComponentValues.Add(InComponentValues);
+	ComponentIndexByName.Add(InComponentValues.ComponentName, Index);
 
-	if (FoundItem)
+	UClass* ComponentClass = InComponentValues.ComponentClass;
+
+	if (ComponentClass->IsChildOf<UMovementComponent>())
 	{
-		return *FoundItem;
+		if (TSharedPtr<IPooledMovementAdapter> Adapter = FPooledMovementAdapterRegistry::Get().FindAdapter(ComponentClass))
+		{
+			FMovementAdapterBinding& Binding = MovementAdapters.AddDefaulted_GetRef();
+			Binding.ComponentIndex = Index;
+			Binding.Adapter = MoveTemp(Adapter);
+		}
 	}
 	
-	static FDefaultComponentValues DefaultItem;
-	return DefaultItem;
-}
+	// particle systems only need their system activated/deactivated
+	if (ComponentClass->IsChildOf<UParticleSystemComponent>())
+	{
+		ParticleSystemIndices.Add(Index);
+		return;
+	}
 
-void FDefaultComponentsValuesContainer::Add(const FDefaultComponentValues& InComponentValues)
-{
-	ComponentValues.Add(InComponentValues);
+	const bool bIsSceneComponent = ComponentClass->IsChildOf<USceneComponent>();
+	if (bIsSceneComponent)
+	{
+		SceneIndices.Add(Index);
+	}
+
+	if (InComponentValues.bAutoActivate)
+	{
+		AutoActivateIndices.Add(Index);
+	}
+
+	// audio just fades out on return, it is not hidden nor deactivated
+	if (ComponentClass->IsChildOf<UAudioComponent>())
+	{
+		AudioIndices.Add(Index);
+		return;
+	}
+
+	if (InComponentValues.bIsPrimitive)
+	{
+		PrimitiveIndices.Add(Index);
+	}
+
+	if (bIsSceneComponent)
+	{
+		HideIndices.Add(Index);
+	}
+
+	DeactivateIndices.Add(Index);
 }
 
 AActorPoolBase::AActorPoolBase(const FObjectInitializer& ObjectInitializer)
@@ -40,6 +85,11 @@ void AActorPoolBase::BeginPlay()
 	Super::BeginPlay();
 
 	TryRegisterWithPoolSubsystem();
+
+	if (WarmAfterIdleTime > 0.f || ColdAfterIdleTime > 0.f)
+	{
+		GetWorldTimerManager().SetTimer(TierUpdateTimerHandle, this, &AActorPoolBase::UpdateFreeActorTiers, TierUpdateInterval, true);
+	}
 }
 
 UObject* AActorPoolBase::PreSpawnPoolObject(TSubclassOf<UObject> InClass, AActor* InOwner)
@@ -47,7 +97,8 @@ UObject* AActorPoolBase::PreSpawnPoolObject(TSubclassOf<UObject> InClass, AActor
 	if (AActor* PoolActor = FindInPool<AActor>(InClass))
 	{
 		UE_LOG(LogPoolSubsystem, Verbose, TEXT("Reusing pool actor %s"), *GetNameSafe(PoolActor));
-		PoolActor->SetOwner(Owner);
+		PromoteToHot(PoolActor);
+		PoolActor->SetOwner(InOwner);
 		return PoolActor;
 	}
 	
@@ -55,6 +106,28 @@ UObject* AActorPoolBase::PreSpawnPoolObject(TSubclassOf<UObject> InClass, AActor
 	UE_LOG(LogPoolSubsystem, Verbose, TEXT("Spawning new pool object %s"), *GetNameSafe(NewActor));
 	// Disable actor instantly, since we might be in the "deferred" spawning state
 	DisableActor(NewActor);
+	// counted against the capacity until it finishes spawning and joins the pool
+	AddPendingSpawn(NewActor);
+
+	BP_OnPreSpawnPoolObject(NewActor);
+	return NewActor;
+}
+
+UObject* AActorPoolBase::PreWarmPoolObject(TSubclassOf<UObject> InClass)
+{
+	AActor* NewActor = GetWorld()->SpawnActorDeferred<AActor>(InClass, FTransform::Identity, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!NewActor)
+	{
+		return nullptr;
+	}
+	
+	UE_LOG(LogPoolSubsystem, Verbose, TEXT("Prewarming pool object %s"), *GetNameSafe(NewActor));
+
+	// Finish spawning while enabled so the component defaults we store are the real ones, then park it as free
+	NewActor->FinishSpawning(FTransform::Identity);
+	TryStoreComponentsDefaultValues(NewActor);
+	PoolObjects.Add(NewActor, true);
+	DisableActor(NewActor);
 
 	BP_OnPreSpawnPoolObject(NewActor);
 	return NewActor;
@@ -71,7 +144,7 @@ void AActorPoolBase::ServerFinishSpawningActor(UObject* InTarget, const FTransfo
 	TargetActor->SetActorTransform(InTransform, false, nullptr, ETeleportType::ResetPhysics);
 	ActivateMovementComponent(TargetActor);
 	SetActorEnabled(TargetActor, true);
-	ForceNetUpdate();
+	RequestNetUpdate();
 }
 
 void AActorPoolBase::ClientFinishSpawningActor(UObject* InTarget, const FTransform& InTransform)
@@ -89,7 +162,7 @@ void AActorPoolBase::ClientFinishSpawningActor(UObject* InTarget, const FTransfo
 	}
 
 	PoolObjects.Add(InTarget, false);
-	ForceNetUpdate();
+	RequestNetUpdate();
 
 	// If we are an actor replicated from the server, we won't have the default values stored
 	TryStoreComponentsDefaultValues(TargetActor);
@@ -111,6 +184,9 @@ void AActorPoolBase::FinishSpawningPoolObject(UObject* InTarget, const FTransfor
 {
 	if (PoolObjects.Contains(InTarget))
 	{
+		// clients reuse replicated actors without going through PreSpawnPoolObject
+		PromoteToHot(Cast<AActor>(InTarget));
+
 		if (HasAuthority())
 		{
 			ServerFinishSpawningActor(InTarget, InTransform);
@@ -125,7 +201,7 @@ void AActorPoolBase::FinishSpawningPoolObject(UObject* InTarget, const FTransfor
 	}
 
 	PoolObjects.Add(InTarget, false);
-	ForceNetUpdate();
+	RequestNetUpdate();
 	
 	AActor* TargetActor = Cast<AActor>(InTarget);
 	PoolObjects.SetItemTransform(TargetActor, TargetActor->GetTransform());
@@ -146,8 +222,83 @@ void AActorPoolBase::ReturnToPool(UObject* InObject)
 	AActor* PoolActor = Cast<AActor>(InObject);
 	check(PoolActor);
 
+	// disabling the actor also puts it to sleep for replication
 	DisableActor(PoolActor);
-	SetReplicationEnabled(PoolActor, false);
+}
+
+void AActorPoolBase::DestroyPoolObject(UObject* InObject)
+{
+	AActor* PoolActor = Cast<AActor>(InObject);
+	check(PoolActor);
+
+	Super::DestroyPoolObject(InObject);
+
+	// the class defaults stay, only the per instance bindings go
+	PooledActorComponentsMap.Remove(PoolActor);
+	PoolActor->Destroy();
+}
+
+void AActorPoolBase::UpdateFreeActorTiers()
+{
+	const double CurrentTime = FPlatformTime::Seconds();
+	TArray<UObject*> IdleObjects;
+
+	// replicated actors are destroyed by the server, clients receive it along with the removal from the pool
+	if (ColdAfterIdleTime > 0.f && HasAuthority())
+	{
+		const double ColdSinceTime = CurrentTime - ColdAfterIdleTime;
+		PoolObjects.GetIdleFreeObjects(EPoolObjectTier::Hot, ColdSinceTime, IdleObjects);
+		PoolObjects.GetIdleFreeObjects(EPoolObjectTier::Warm, ColdSinceTime, IdleObjects);
+
+		// same floor as trimming, the idle actors kept above it stay in the pool
+		TMap<const UClass*, int32> DestroyableCountByClass;
+		for (UObject* IdleObject : IdleObjects)
+		{
+			const UClass* IdleClass = IdleObject->GetClass();
+			int32* DestroyableCount = DestroyableCountByClass.Find(IdleClass);
+			if (!DestroyableCount)
+			{
+				DestroyableCount = &DestroyableCountByClass.Add(IdleClass, PoolObjects.NumFreeOfClass(IdleClass) - GetKeptFreeCount(IdleClass));
+			}
+
+			if (*DestroyableCount > 0)
+			{
+				--*DestroyableCount;
+				DestroyPoolObject(IdleObject);
+			}
+		}
+
+		IdleObjects.Reset();
+	}
+
+	if (WarmAfterIdleTime > 0.f)
+	{
+		PoolObjects.GetIdleFreeObjects(EPoolObjectTier::Hot, CurrentTime - WarmAfterIdleTime, IdleObjects);
+		for (UObject* IdleObject : IdleObjects)
+		{
+			DemoteToWarm(static_cast<AActor*>(IdleObject));
+		}
+	}
+}
+
+void AActorPoolBase::DemoteToWarm(AActor* InTarget)
+{
+	UE_LOG(LogPoolSubsystem, Verbose, TEXT("Pool actor %s is now warm"), *GetNameSafe(InTarget));
+
+	// the actor is already disabled, unregistering drops its render proxies and physics bodies while keeping the components
+	InTarget->UnregisterAllComponents();
+	PoolObjects.SetObjectTier(InTarget, EPoolObjectTier::Warm);
+}
+
+void AActorPoolBase::PromoteToHot(AActor* InTarget)
+{
+	if (!InTarget || PoolObjects.GetObjectTier(InTarget) != EPoolObjectTier::Warm)
+	{
+		return;
+	}
+
+	InTarget->RegisterAllComponents();
+	PoolObjects.SetObjectTier(InTarget, EPoolObjectTier::Hot);
 }
 
 void AActorPoolBase::Tick(float DeltaSeconds)
@@ -188,7 +339,7 @@ void AActorPoolBase::TryRegisterWithPoolSubsystem()
 
 void AActorPoolBase::TryStoreComponentsDefaultValues(AActor* InTarget)
 {
-	if (ActorDefaultComponentValuesMap.Contains(InTarget))
+	if (PooledActorComponentsMap.Contains(InTarget))
 	{
 		return;
 	}
@@ -196,66 +347,123 @@ void AActorPoolBase::TryStoreComponentsDefaultValues(AActor* InTarget)
 	TInlineComponentArray<UActorComponent*> Components;
 	InTarget->GetComponents<UActorComponent>(Components);
 
-	FDefaultComponentsValuesContainer ComponentsValuesContainer;
-	for (UActorComponent* Component : Components)
+	/* Defaults come from the class archetypes of the components (the CDO subobjects or the blueprint templates), never
+	 * from a live instance: on clients the first actor we see can already be disabled by the pool. Instances only map
+	 * their components to them */
+	FDefaultComponentsValuesContainer* ComponentsValuesContainer = ClassDefaultComponentValuesMap.Find(InTarget->GetClass());
+	if (!ComponentsValuesContainer)
 	{
-		FDefaultComponentValues DefaultValues;
-		DefaultValues.Component = Component;
-		DefaultValues.bAutoActivate = Component->bAutoActivate;
-		
-		const USceneComponent* SceneComponent = Cast<USceneComponent>(Component);
-		if (SceneComponent)
+		ComponentsValuesContainer = &ClassDefaultComponentValuesMap.Add(InTarget->GetClass());
+		for (UActorComponent* Component : Components)
 		{
-			DefaultValues.Component = Component;
-			bool bShouldCheckAutoActivate = Component->IsA(UFXSystemComponent::StaticClass()) || Component->IsA(UAudioComponent::StaticClass());
-			DefaultValues.bAutoActivate = !bShouldCheckAutoActivate || Component->bAutoActivate;
-			DefaultValues.bVisible = SceneComponent->IsVisible();
-			DefaultValues.bHiddenInGame = SceneComponent->bHiddenInGame;
-			DefaultValues.RelativeTransform = SceneComponent->GetRelativeTransform();
-			if (UPrimitiveComponent* PrimitiveComponent = Cast<UPrimitiveComponent>(Component))
+			// components added at runtime have their class default object as archetype
+			const UActorComponent* Archetype = CastChecked<UActorComponent>(Component->GetArchetype());
+
+			FDefaultComponentValues DefaultValues;
+			DefaultValues.ComponentName = Component->GetFName();
+			DefaultValues.ComponentClass = Component->GetClass();
+			DefaultValues.bAutoActivate = Archetype->bAutoActivate;
+			
+			const USceneComponent* SceneComponent = Cast<USceneComponent>(Archetype);
+			if (SceneComponent)
 			{
-				DefaultValues.bGravityEnabled = PrimitiveComponent->IsGravityEnabled();
-				DefaultValues.bSimulatesPhysics = PrimitiveComponent->IsSimulatingPhysics();
-				DefaultValues.CollisionEnabled = PrimitiveComponent->GetCollisionEnabled();
+				bool bShouldCheckAutoActivate = Component->IsA(UFXSystemComponent::StaticClass()) || Component->IsA(UAudioComponent::StaticClass());
+				DefaultValues.bAutoActivate = !bShouldCheckAutoActivate || Archetype->bAutoActivate;
+				DefaultValues.bVisible = SceneComponent->GetVisibleFlag();
+				DefaultValues.bHiddenInGame = SceneComponent->bHiddenInGame;
+				DefaultValues.RelativeTransform = SceneComponent->GetRelativeTransform();
+				if (const UPrimitiveComponent* PrimitiveComponent = Cast<UPrimitiveComponent>(Archetype))
+				{
+					// read from the body setup of the template, it has no physics state to query
+					DefaultValues.bIsPrimitive = true;
+					DefaultValues.bGravityEnabled = PrimitiveComponent->BodyInstance.bEnableGravity;
+					DefaultValues.bSimulatesPhysics = PrimitiveComponent->BodyInstance.bSimulatePhysics;
+					DefaultValues.CollisionEnabled = PrimitiveComponent->BodyInstance.GetCollisionEnabled(false);
+					DefaultValues.CollisionResponses = PrimitiveComponent->BodyInstance.GetResponseToChannels();
+				}
 			}
+			
+			ComponentsValuesContainer->Add(DefaultValues);
+		}
+	}
+
+	FPooledActorComponents& ActorComponents = PooledActorComponentsMap.Add(InTarget);
+	InTarget->OnDestroyed.AddUniqueDynamic(this, &AActorPoolBase::OnPooledActorDestroyed);
+	ActorComponents.Components.SetNum(ComponentsValuesContainer->ComponentValues.Num());
+	for (UActorComponent* Component : Components)
+	{
+		// components added at runtime that the class defaults do not know about are left untouched
+		const int32 ComponentIndex = ComponentsValuesContainer->FindComponentIndex(Component->GetFName());
+		if (ComponentIndex != INDEX_NONE && ComponentsValuesContainer->ComponentValues[ComponentIndex].ComponentClass == Component->GetClass())
+		{
+			ActorComponents.Components[ComponentIndex] = Component;
 		}
-		
-		ComponentsValuesContainer.Add(DefaultValues);
 	}
-	ActorDefaultComponentValuesMap.Add(InTarget, ComponentsValuesContainer);
+}
+
+void AActorPoolBase::OnPooledActorDestroyed(AActor* DestroyedActor)
+{
+	PooledActorComponentsMap.Remove(DestroyedActor);
+}
+
+const FDefaultComponentsValuesContainer* AActorPoolBase::FindComponentsDefaultValues(AActor* InTarget, const FPooledActorComponents*& OutActorComponents) const
+{
+	OutActorComponents = PooledActorComponentsMap.Find(InTarget);
+	return OutActorComponents ? ClassDefaultComponentValuesMap.Find(InTarget->GetClass()) : nullptr;
 }
 
 void AActorPoolBase::ActiveActorComponents(AActor* InTarget)
 {
-	FDefaultComponentsValuesContainer* DefaultValues = ActorDefaultComponentValuesMap.Find(InTarget);
-	for (const FDefaultComponentValues& ComponentValues : DefaultValues->ComponentValues)
+	const FPooledActorComponents* ActorComponents = nullptr;
+	const FDefaultComponentsValuesContainer* DefaultValues = FindComponentsDefaultValues(InTarget, ActorComponents);
+	if (!DefaultValues)
 	{
-		UActorComponent* Component = ComponentValues.Component.Get();
-		check(Component);
+		return;
+	}
 
-		if (UParticleSystemComponent* FXComp = Cast<UParticleSystemComponent>(Component))
+	// components are bound by name and class, so the plan tells us their type without casting
+	const TArray<TWeakObjectPtr<UActorComponent>>& Components = ActorComponents->Components;
+	for (const int32 ComponentIndex : DefaultValues->ParticleSystemIndices)
+	{
+		if (UParticleSystemComponent* FXComp = static_cast<UParticleSystemComponent*>(Components[ComponentIndex].Get()))
 		{
 			FXComp->TickComponent(0.0f, LEVELTICK_All, nullptr);
 			FXComp->ActivateSystem();
-			continue;
 		}
+	}
 
-		const FDefaultComponentValues& ComponentDefaultValues = DefaultValues->FindComponent(Component);
-		if (USceneComponent* SceneComp = Cast<USceneComponent>(Component))
+	for (const int32 ComponentIndex : DefaultValues->SceneIndices)
+	{
+		USceneComponent* SceneComp = static_cast<USceneComponent*>(Components[ComponentIndex].Get());
+		if (!SceneComp)
+		{
+			continue;
+		}
+		
+		const FDefaultComponentValues& ComponentDefaultValues = DefaultValues->ComponentValues[ComponentIndex];
+		SceneComp->SetRelativeTransform(ComponentDefaultValues.RelativeTransform, false, nullptr, ETeleportType::ResetPhysics);
+		if (ComponentDefaultValues.bIsPrimitive)
 		{
-			SceneComp->SetRelativeTransform(ComponentDefaultValues.RelativeTransform, false, nullptr, ETeleportType::ResetPhysics);
-			if (UPrimitiveComponent* PrimitiveComp = Cast<UPrimitiveComponent>(Component))
+			UPrimitiveComponent* PrimitiveComp = static_cast<UPrimitiveComponent*>(SceneComp);
+			if (bUsePhysicsParking)
+			{
+				UnparkPrimitiveComponent(PrimitiveComp, ComponentDefaultValues);
+			}
+			else
 			{
 				PrimitiveComp->SetEnableGravity(ComponentDefaultValues.bGravityEnabled);
 				PrimitiveComp->SetCollisionEnabled(ComponentDefaultValues.CollisionEnabled);
 				PrimitiveComp->SetSimulatePhysics(ComponentDefaultValues.bSimulatesPhysics);
 			}
-			
-			SceneComp->SetHiddenInGame(ComponentDefaultValues.bHiddenInGame);
-			SceneComp->SetVisibility(ComponentDefaultValues.bVisible);
 		}
 		
-		if (ComponentDefaultValues.bAutoActivate)
+		SceneComp->SetHiddenInGame(ComponentDefaultValues.bHiddenInGame);
+		SceneComp->SetVisibility(ComponentDefaultValues.bVisible);
+	}
+
+	for (const int32 ComponentIndex : DefaultValues->AutoActivateIndices)
+	{
+		if (UActorComponent* Component = Components[ComponentIndex].Get())
 		{
 			Component->Activate();
 		}
@@ -264,69 +472,138 @@ void AActorPoolBase::ActiveActorComponents(AActor* InTarget)
 
 void AActorPoolBase::ActivateMovementComponent(AActor* InTarget)
 {
-	// Get the default component from the default object
-	UProjectileMovementComponent* ProjMoveComp = InTarget->FindComponentByClass<UProjectileMovementComponent>();
-	if (ProjMoveComp)
+	const FPooledActorComponents* ActorComponents = nullptr;
+	const FDefaultComponentsValuesContainer* DefaultValues = FindComponentsDefaultValues(InTarget, ActorComponents);
+	if (!DefaultValues)
 	{
-		ProjMoveComp->SetUpdatedComponent(InTarget->GetRootComponent());
-		if (ProjMoveComp->Velocity.SizeSquared() > 0.f)
-		{
-			// InitialSpeed > 0 overrides initial velocity magnitude.
-			if (ProjMoveComp->InitialSpeed > 0.f)
-			{
-				ProjMoveComp->Velocity = ProjMoveComp->Velocity.GetSafeNormal() * ProjMoveComp->InitialSpeed;
-			}
+		return;
+	}
 
-			if (ProjMoveComp->bInitialVelocityInLocalSpace)
-			{
-				ProjMoveComp->SetVelocityInLocalSpace(ProjMoveComp->Velocity);
-			}
+	for (const FDefaultComponentsValuesContainer::FMovementAdapterBinding& Binding : DefaultValues->MovementAdapters)
+	{
+		if (UMovementComponent* MovementComponent = static_cast<UMovementComponent*>(ActorComponents->Components[Binding.ComponentIndex].Get()))
+		{
+			Binding.Adapter->ReactivateMovement(MovementComponent, InTarget);
+		}
+	}
+}
 
-			if (ProjMoveComp->bRotationFollowsVelocity)
-			{
-				if (ProjMoveComp->UpdatedComponent)
-				{
-					FRotator DesiredRotation = ProjMoveComp->Velocity.Rotation();
-					if (ProjMoveComp->bRotationRemainsVertical)
-					{
-						DesiredRotation.Pitch = 0.0f;
-						DesiredRotation.Yaw = FRotator::NormalizeAxis(DesiredRotation.Yaw);
-						DesiredRotation.Roll = 0.0f;
-					}
-
-					ProjMoveComp->UpdatedComponent->SetWorldRotation(DesiredRotation);
-				}
-			}
+void AActorPoolBase::ResetMovementComponents(AActor* InTarget)
+{
+	const FPooledActorComponents* ActorComponents = nullptr;
+	const FDefaultComponentsValuesContainer* DefaultValues = FindComponentsDefaultValues(InTarget, ActorComponents);
+	if (!DefaultValues)
+	{
+		return;
+	}
 
-			ProjMoveComp->UpdateComponentVelocity();
-		
-			if (ProjMoveComp->UpdatedPrimitive && ProjMoveComp->UpdatedPrimitive->IsSimulatingPhysics())
-			{
-				ProjMoveComp->UpdatedPrimitive->SetPhysicsLinearVelocity(ProjMoveComp->Velocity);
-			}
+	for (const FDefaultComponentsValuesContainer::FMovementAdapterBinding& Binding : DefaultValues->MovementAdapters)
+	{
+		if (UMovementComponent* MovementComponent = static_cast<UMovementComponent*>(ActorComponents->Components[Binding.ComponentIndex].Get()))
+		{
+			Binding.Adapter->ResetMovement(MovementComponent, InTarget);
 		}
 	}
 }
 
 void AActorPoolBase::ResetComponentsTransform(AActor* InTarget)
 {
-	FDefaultComponentsValuesContainer* DefaultValues = ActorDefaultComponentValuesMap.Find(InTarget);
-	for (const FDefaultComponentValues& ComponentValues : DefaultValues->ComponentValues)
+	const FPooledActorComponents* ActorComponents = nullptr;
+	const FDefaultComponentsValuesContainer* DefaultValues = FindComponentsDefaultValues(InTarget, ActorComponents);
+	if (!DefaultValues)
 	{
-		USceneComponent* Component = Cast<USceneComponent>(ComponentValues.Component.Get());
+		return;
+	}
+	
+	for (const int32 ComponentIndex : DefaultValues->SceneIndices)
+	{
+		USceneComponent* Component = static_cast<USceneComponent*>(ActorComponents->Components[ComponentIndex].Get());
 		if (!Component)
 		{
 			continue;
 		}
-		check(Component);
-		Component->SetRelativeTransform(ComponentValues.RelativeTransform, false, nullptr, ETeleportType::ResetPhysics);
+		
+		Component->SetRelativeTransform(DefaultValues->ComponentValues[ComponentIndex].RelativeTransform, false, nullptr, ETeleportType::ResetPhysics);
 	}
 }
 
 void AActorPoolBase::DeactivateComponents(AActor* InTarget)
+{
+	const FPooledActorComponents* ActorComponents = nullptr;
+	const FDefaultComponentsValuesContainer* DefaultValues = FindComponentsDefaultValues(InTarget, ActorComponents);
+	if (!DefaultValues)
+	{
+		DeactivateUnboundComponents(InTarget);
+		return;
+	}
+
+	const TArray<TWeakObjectPtr<UActorComponent>>& Components = ActorComponents->Components;
+	for (const int32 ComponentIndex : DefaultValues->ParticleSystemIndices)
+	{
+		if (UParticleSystemComponent* PfxComp = static_cast<UParticleSystemComponent*>(Components[ComponentIndex].Get()))
+		{
+			PfxComp->TickComponent(0.0f, LEVELTICK_All, nullptr);
+			PfxComp->DeactivateSystem();
+		}
+	}
+
+	for (const int32 ComponentIndex : DefaultValues->AudioIndices)
+	{
+		UAudioComponent* AudioComp = static_cast<UAudioComponent*>(Components[ComponentIndex].Get());
+		if (AudioComp && (AudioComp->Sound != nullptr) && (AudioComp->Sound->GetDuration() >= INDEFINITELY_LOOPING_DURATION))
+		{
+			static const float AudioDestroyFadouttime = 0.2f;
+			AudioComp->FadeOut(AudioDestroyFadouttime, 0.0f);
+		}
+	}
+
+	for (const int32 ComponentIndex : DefaultValues->PrimitiveIndices)
+	{
+		UPrimitiveComponent* PrimitiveComp = static_cast<UPrimitiveComponent*>(Components[ComponentIndex].Get());
+		if (!PrimitiveComp)
+		{
+			continue;
+		}
+		
+		const TArray<FOverlapInfo> OverlapArray(PrimitiveComp->GetOverlapInfos());
+		for (const FOverlapInfo& OverlapInfo : OverlapArray)
+		{
+			PrimitiveComp->EndComponentOverlap(OverlapInfo);
+		}
+
+		if (bUsePhysicsParking)
+		{
+			ParkPrimitiveComponent(PrimitiveComp);
+			continue;
+		}
+		
+		PrimitiveComp->SetSimulatePhysics(false);
+		PrimitiveComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		PrimitiveComp->SetEnableGravity(false);
+	}
+
+	for (const int32 ComponentIndex : DefaultValues->HideIndices)
+	{
+		if (USceneComponent* SceneComponent = static_cast<USceneComponent*>(Components[ComponentIndex].Get()))
+		{
+			SceneComponent->SetHiddenInGame(true);
+			SceneComponent->SetVisibility(false);
+		}
+	}
+
+	for (const int32 ComponentIndex : DefaultValues->DeactivateIndices)
+	{
+		if (UActorComponent* Component = Components[ComponentIndex].Get())
+		{
+			Component->Deactivate();
+		}
+	}
+}
+
+void AActorPoolBase::DeactivateUnboundComponents(AActor* InTarget)
 {
 	/* reset and deactivate components, cast to specific types
-	 * if it needs special handling
+	 * if it needs special handling. Only used until the actor is bound to its class defaults (e.g deferred spawns)
 	 */
 	TInlineComponentArray<UActorComponent*> Components;
 	InTarget->GetComponents<UActorComponent>(Components);
@@ -381,17 +658,102 @@ void AActorPoolBase::DisableActor(AActor* InTarget)
 {
 	InTarget->SetOwner(nullptr);
 	InTarget->SetInstigator(nullptr);
+
+	if (ShouldParkActor(InTarget))
+	{
+		SetActorEnabled(InTarget, false);
+		DeactivateComponents(InTarget);
+		ResetMovementComponents(InTarget);
+
+		// bodies ignore everything by now, teleport them away and only then let them sleep so the move does not wake them
+		InTarget->SetActorTransform(FTransform(ParkingLocation), false, nullptr, ETeleportType::TeleportPhysics);
+		PutParkedBodiesToSleep(InTarget);
+		return;
+	}
+
 	InTarget->SetActorTransform(FTransform::Identity);
 	
 	SetActorEnabled(InTarget, false);
 	DeactivateComponents(InTarget);
+	ResetMovementComponents(InTarget);
+}
+
+bool AActorPoolBase::ShouldParkActor(AActor* InTarget) const
+{
+	// actors not bound to their class defaults yet (e.g deferred spawns) have nothing to restore their collision from
+	return bUsePhysicsParking && PooledActorComponentsMap.Contains(InTarget);
+}
+
+void AActorPoolBase::ParkPrimitiveComponent(UPrimitiveComponent* PrimitiveComp)
+{
+	// only the collision filter changes, the body and its simulation state stay as they are
+	PrimitiveComp->SetCollisionResponseToAllChannels(ECR_Ignore);
+}
+
+void AActorPoolBase::UnparkPrimitiveComponent(UPrimitiveComponent* PrimitiveComp, const FDefaultComponentValues& ComponentDefaultValues)
+{
+	PrimitiveComp->SetCollisionResponseToChannels(ComponentDefaultValues.CollisionResponses);
+
+	// parked bodies keep these, they only differ the first time a body that was deactivated before being bound is reused
+	if (PrimitiveComp->GetCollisionEnabled() != ComponentDefaultValues.CollisionEnabled)
+	{
+		PrimitiveComp->SetCollisionEnabled(ComponentDefaultValues.CollisionEnabled);
+	}
+
+	if (PrimitiveComp->IsGravityEnabled() != ComponentDefaultValues.bGravityEnabled)
+	{
+		PrimitiveComp->SetEnableGravity(ComponentDefaultValues.bGravityEnabled);
+	}
+
+	if (PrimitiveComp->IsSimulatingPhysics() != ComponentDefaultValues.bSimulatesPhysics)
+	{
+		PrimitiveComp->SetSimulatePhysics(ComponentDefaultValues.bSimulatesPhysics);
+	}
+	else if (ComponentDefaultValues.bSimulatesPhysics)
+	{
+		PrimitiveComp->WakeRigidBody();
+	}
+}
+
+void AActorPoolBase::PutParkedBodiesToSleep(AActor* InTarget)
+{
+	const FPooledActorComponents* ActorComponents = nullptr;
+	const FDefaultComponentsValuesContainer* DefaultValues = FindComponentsDefaultValues(InTarget, ActorComponents);
+	if (!DefaultValues)
+	{
+		return;
+	}
+
+	for (const int32 ComponentIndex : DefaultValues->PrimitiveIndices)
+	{
+		UPrimitiveComponent* PrimitiveComp = static_cast<UPrimitiveComponent*>(ActorComponents->Components[ComponentIndex].Get());
+		if (PrimitiveComp && PrimitiveComp->IsSimulatingPhysics())
+		{
+			PrimitiveComp->SetPhysicsLinearVelocity(FVector::ZeroVector);
+			PrimitiveComp->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+			PrimitiveComp->PutRigidBodyToSleep();
+		}
+	}
 }
 
 void AActorPoolBase::SetActorEnabled(AActor* InTarget, bool bEnabled)
 {
 	InTarget->SetActorHiddenInGame(!bEnabled);
 	InTarget->SetActorTickEnabled(bEnabled && InTarget->PrimaryActorTick.bStartWithTickEnabled);
-	InTarget->SetActorEnableCollision(bEnabled);
+	// parked actors keep their collision, enabling it again is a no-op for them
+	if (bEnabled || !ShouldParkActor(InTarget))
+	{
+		InTarget->SetActorEnableCollision(bEnabled);
+	}
+
+	// clients wait for the actor to be awake before spawning it, so only the authority can wait for the end of the frame
+	UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>();
+	if (HasAuthority() && PoolSubsystem)
+	{
+		PoolSubsystem->RequestActorNetUpdate(InTarget, bEnabled ? DORM_Awake : DORM_DormantAll);
+		return;
+	}
+
 	SetReplicationEnabled(InTarget, bEnabled);
 	InTarget->ForceNetUpdate();
 }
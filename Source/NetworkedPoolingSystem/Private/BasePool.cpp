@@ -4,8 +4,6 @@
 #include "BasePool.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
-#include "Misc/Paths.h"
-#include "HAL/FileManager.h"
 #include "Misc/App.h"
 #include "GeneralProjectSettings.h"
 #include "PoolInterface.h"
@@ -14,6 +12,7 @@
 #include "Engine/AssetManager.h"
 #include "GameFramework/GameStateBase.h"
 #include "Net/UnrealNetwork.h"
+#include "HAL/PlatformTime.h"
 
 ABasePool::ABasePool(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
@@ -29,15 +28,51 @@ void ABasePool::BeginPlay()
 	Super::BeginPlay();
 	
 	PoolObjects.SetOwningPool(this);
+
+#if WITH_EDITOR
+	ObjectsReinstancedHandle = FCoreUObjectDelegates::OnObjectsReinstanced.AddUObject(this, &ABasePool::OnObjectsReinstanced);
+#endif
+
+	// pools spawned from code or older assets never went through PostEditChangeProperty
+	if (!ClampFreeWatermarks())
+	{
+		UE_LOG(LogPoolSubsystem, Warning, TEXT("Pool %s has FreeLowWatermark above FreeHighWatermark, clamped it to %d"), *GetNameSafe(this), FreeLowWatermark);
+	}
+
+	if (HasAuthority() && (FreeHighWatermark > 0 || TrimIdleTime > 0.f))
+	{
+		GetWorldTimerManager().SetTimer(TrimTimerHandle, FTimerDelegate::CreateUObject(this, &ABasePool::TrimFreeObjects, false), TrimInterval, true);
+	}
+
+	if (HasAuthority() && bAdaptivePreWarm)
+	{
+		LastDemandUpdateTime = GetWorld()->GetTimeSeconds();
+		GetWorldTimerManager().SetTimer(AdaptivePreWarmTimerHandle, this, &ABasePool::UpdateAdaptivePreWarm, AdaptiveUpdateInterval, true);
+	}
 }
 
 void ABasePool::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
+	PropertyResetPlans.Reset();
+	ProjectClassCache.Reset();
+	ActiveObjectsByOwner.Reset();
+	ActiveObjectOwners.Reset();
+	DemandByClass.Reset();
+
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectsReinstanced.Remove(ObjectsReinstancedHandle);
+#endif
+
 	if (GetWorld())
 	{
 		GetWorld()->GetTimerManager().ClearAllTimersForObject(this);
+
+		if (UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>())
+		{
+			PoolSubsystem->UnregisterPool(this);
+		}
 	}
 }
 
@@ -47,15 +82,312 @@ void ABasePool::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetim
 	DOREPLIFETIME(ThisClass, PoolObjects);
 }
 
+#if WITH_EDITOR
+void ABasePool::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(ABasePool, FreeLowWatermark) || PropertyName == GET_MEMBER_NAME_CHECKED(ABasePool, FreeHighWatermark))
+	{
+		ClampFreeWatermarks();
+	}
+}
+
+void ABasePool::OnObjectsReinstanced(const TMap<UObject*, UObject*>& OldToNewInstanceMap)
+{
+	// recompiled classes can change their properties and package, both caches are built again on demand
+	PropertyResetPlans.Reset();
+	ProjectClassCache.Reset();
+}
+#endif
+
+bool ABasePool::ClampFreeWatermarks()
+{
+	if (FreeHighWatermark > 0 && FreeLowWatermark > FreeHighWatermark)
+	{
+		FreeLowWatermark = FreeHighWatermark;
+		return false;
+	}
+
+	return true;
+}
+
 UObject* ABasePool::PreSpawnPoolObject(TSubclassOf<UObject> InClass, AActor* InOwner)
 {
 	return nullptr;
 }
 
+UObject* ABasePool::AcquirePoolObject(TSubclassOf<UObject> InClass, AActor* InOwner)
+{
+	if (!MakeRoomForOwner(InOwner))
+	{
+		UE_LOG(LogPoolSubsystem, Verbose, TEXT("%s reached its quota on pool %s, refusing %s"), *GetNameSafe(InOwner), *GetNameSafe(this), *GetNameSafe(InClass));
+		return nullptr;
+	}
+
+	if (bAdaptivePreWarm)
+	{
+		++DemandByClass.FindOrAdd(InClass.Get()).Acquisitions;
+	}
+
+	const bool bHasFreeObject = PoolObjects.HasFreeObject(InClass);
+	if (!bHasFreeObject)
+	{
+		++UsageByClass.FindOrAdd(InClass.Get()).MissCount;
+	}
+
+	if (!bHasFreeObject && IsAtCapacity(InClass))
+	{
+		++OverflowStats.OverflowCount;
+		switch (OverflowPolicy)
+		{
+		case EPoolOverflowPolicy::Grow:
+			++OverflowStats.GrownCount;
+			break;
+		case EPoolOverflowPolicy::RecycleOldest:
+			if (UObject* OldestObject = PoolObjects.GetOldestActiveObject(InClass))
+			{
+				UE_LOG(LogPoolSubsystem, Verbose, TEXT("Pool %s is full, recycling %s"), *GetNameSafe(this), *GetNameSafe(OldestObject));
+				// goes through the subsystem so the object gets its deactivate event before being reused
+				UPoolSubsystem::ReturnToPool(OldestObject);
+				if (DoesObjectBelongsToPool(OldestObject) && IsObjectFree(OldestObject))
+				{
+					++OverflowStats.RecycledCount;
+					break;
+				}
+
+				UE_LOG(LogPoolSubsystem, Warning, TEXT("Pool %s is full and could not recycle %s, refusing %s"), *GetNameSafe(this), *GetNameSafe(OldestObject), *GetNameSafe(InClass));
+			}
+			++OverflowStats.FailedCount;
+			return nullptr;
+		case EPoolOverflowPolicy::Queue:
+			// requests made through RequestPoolObjectQueued never get here, the subsystem holds them until there is room
+			UE_LOG(LogPoolSubsystem, Warning, TEXT("Pool %s is full and queues its requests, %s was not requested through RequestPoolObjectQueued so it is refused"), *GetNameSafe(this), *GetNameSafe(InClass));
+			++OverflowStats.FailedCount;
+			return nullptr;
+		default:
+			UE_LOG(LogPoolSubsystem, Verbose, TEXT("Pool %s is full, refusing %s"), *GetNameSafe(this), *GetNameSafe(InClass));
+			++OverflowStats.FailedCount;
+			return nullptr;
+		}
+	}
+
+	// counted before spawning, new actors only join the pool once they finish spawning so the ones still spawning are added
+	const int32 ActiveCount = PoolObjects.NumOfClass(InClass) - PoolObjects.NumFreeOfClass(InClass) + NumPendingSpawns(InClass) + 1;
+	UObject* PoolObject = PreSpawnPoolObject(InClass, InOwner);
+	if (PoolObject)
+	{
+		FPoolClassUsage& Usage = UsageByClass.FindOrAdd(InClass.Get());
+		Usage.HighWaterMark = FMath::Max(Usage.HighWaterMark, ActiveCount);
+	}
+
+	if (PoolObject && InOwner)
+	{
+		TrackOwnedObject(PoolObject, InOwner);
+	}
+
+	OverflowStats.PeakSize = FMath::Max(OverflowStats.PeakSize, PoolObjects.Num());
+	return PoolObject;
+}
+
+int32 ABasePool::GetNumActiveObjectsOwnedBy(const AActor* InOwner) const
+{
+	const TArray<TWeakObjectPtr<UObject>>* OwnedObjects = ActiveObjectsByOwner.Find(InOwner);
+	return OwnedObjects ? OwnedObjects->Num() : 0;
+}
+
+void ABasePool::GetActiveObjectsOwnedBy(const AActor* InOwner, TArray<UObject*>& OutObjects) const
+{
+	if (const TArray<TWeakObjectPtr<UObject>>* OwnedObjects = ActiveObjectsByOwner.Find(InOwner))
+	{
+		for (const TWeakObjectPtr<UObject>& OwnedObject : *OwnedObjects)
+		{
+			if (UObject* Object = OwnedObject.Get())
+			{
+				OutObjects.Add(Object);
+			}
+		}
+	}
+}
+
+void ABasePool::GetActiveObjectsOfClass(TSubclassOf<UObject> InClass, TArray<UObject*>& OutObjects)
+{
+	PoolObjects.GetActiveObjectsOfClass(InClass, OutObjects);
+}
+
+void ABasePool::RequestNetUpdate()
+{
+	if (UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>())
+	{
+		PoolSubsystem->RequestPoolNetUpdate(this);
+		return;
+	}
+
+	ForceNetUpdate();
+}
+
+bool ABasePool::MakeRoomForOwner(AActor* InOwner)
+{
+	if (!InOwner || MaxActiveObjectsPerOwner <= 0)
+	{
+		return true;
+	}
+
+	TArray<TWeakObjectPtr<UObject>>* OwnedObjects = ActiveObjectsByOwner.Find(InOwner);
+	if (!OwnedObjects || OwnedObjects->Num() < MaxActiveObjectsPerOwner)
+	{
+		return true;
+	}
+
+	// objects destroyed while active never came back to untrack themselves, they do not count
+	OwnedObjects->RemoveAll([](const TWeakObjectPtr<UObject>& OwnedObject)
+	{
+		return !OwnedObject.IsValid();
+	});
+	if (OwnedObjects->Num() < MaxActiveObjectsPerOwner)
+	{
+		return true;
+	}
+
+	if (OwnerQuotaPolicy == EPoolOwnerQuotaPolicy::RecycleOwnOldest)
+	{
+		// only an active object of this pool can be recycled, e.g a deferred actor the caller did not finish yet can not
+		UObject* OldestObject = (*OwnedObjects)[0].Get();
+		if (DoesObjectBelongsToPool(OldestObject) && !IsObjectFree(OldestObject))
+		{
+			const int32 NumOwnedObjects = OwnedObjects->Num();
+			UPoolSubsystem::ReturnToPool(OldestObject);
+
+			// returning it untracks it, which can also drop the owner entry
+			const TArray<TWeakObjectPtr<UObject>>* RemainingObjects = ActiveObjectsByOwner.Find(InOwner);
+			if (!RemainingObjects || RemainingObjects->Num() < NumOwnedObjects)
+			{
+				++OverflowStats.QuotaRecycledCount;
+				return true;
+			}
+		}
+
+		UE_LOG(LogPoolSubsystem, Verbose, TEXT("Could not recycle %s for %s on pool %s"), *GetNameSafe(OldestObject), *GetNameSafe(InOwner), *GetNameSafe(this));
+	}
+
+	++OverflowStats.QuotaRejectedCount;
+	return false;
+}
+
+void ABasePool::TrackOwnedObject(UObject* Object, AActor* InOwner)
+{
+	ActiveObjectsByOwner.FindOrAdd(InOwner).Add(Object);
+	ActiveObjectOwners.Add(Object, InOwner);
+}
+
+void ABasePool::UntrackOwnedObject(UObject* Object)
+{
+	TObjectKey<AActor> OwnerKey;
+	if (!ActiveObjectOwners.RemoveAndCopyValue(Object, OwnerKey))
+	{
+		return;
+	}
+
+	if (TArray<TWeakObjectPtr<UObject>>* OwnedObjects = ActiveObjectsByOwner.Find(OwnerKey))
+	{
+		// keeps the order, the first one is the next to recycle
+		OwnedObjects->RemoveSingle(Object);
+		if (OwnedObjects->IsEmpty())
+		{
+			ActiveObjectsByOwner.Remove(OwnerKey);
+		}
+	}
+}
+
+void ABasePool::NotifyRequestQueued()
+{
+	++OverflowStats.OverflowCount;
+	++OverflowStats.QueuedCount;
+}
+
+bool ABasePool::IsAtCapacity(TSubclassOf<UObject> InClass)
+{
+	// objects still spawning are not in the pool yet but they already take a slot
+	if (MaxPoolSize > 0 && PoolObjects.Num() + NumPendingSpawns() >= MaxPoolSize)
+	{
+		return true;
+	}
+
+	const int32* MaxObjects = MaxObjectsPerClass.Find(InClass);
+	return MaxObjects && PoolObjects.NumOfClass(InClass.Get()) + NumPendingSpawns(InClass.Get()) >= *MaxObjects;
+}
+
+void ABasePool::AddPendingSpawn(UObject* Object)
+{
+	if (Object)
+	{
+		PendingSpawnsByClass.FindOrAdd(Object->GetClass()).Add(Object);
+	}
+}
+
+void ABasePool::RemovePendingSpawn(UObject* Object)
+{
+	if (!Object)
+	{
+		return;
+	}
+
+	if (TArray<TWeakObjectPtr<UObject>>* PendingSpawns = PendingSpawnsByClass.Find(Object->GetClass()))
+	{
+		PendingSpawns->RemoveSingleSwap(Object);
+		if (PendingSpawns->IsEmpty())
+		{
+			PendingSpawnsByClass.Remove(Object->GetClass());
+		}
+	}
+}
+
+int32 ABasePool::NumPendingSpawns(const UClass* InClass)
+{
+	int32 NumPending = 0;
+	for (auto It = PendingSpawnsByClass.CreateIterator(); It; ++It)
+	{
+		if (InClass && It.Key() != TObjectKey<UClass>(InClass))
+		{
+			continue;
+		}
+
+		It.Value().RemoveAllSwap([](const TWeakObjectPtr<UObject>& PendingSpawn) { return !PendingSpawn.IsValid(); });
+		if (It.Value().IsEmpty())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		NumPending += It.Value().Num();
+	}
+
+	return NumPending;
+}
+
+UObject* ABasePool::PreWarmPoolObject(TSubclassOf<UObject> InClass)
+{
+	// Generic fallback, request a full object and give it back right away
+	UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>();
+	UObject* SpawnedObject = PoolSubsystem->RequestPoolObject<UObject>(InClass, this, false);
+	if (SpawnedObject)
+	{
+		PoolSubsystem->ReturnToPool(SpawnedObject);
+	}
+	
+	return SpawnedObject;
+}
+
 void ABasePool::FinishSpawningPoolObject(UObject* Target, const FTransform& Transform)
 {
 	UE_LOG(LogPoolSubsystem, Verbose, TEXT("finished spawning pool object %s"), *GetNameSafe(Target));
 
+	RemovePendingSpawn(Target);
+
+	// actors only join the pool once they finish spawning
+	OverflowStats.PeakSize = FMath::Max(OverflowStats.PeakSize, PoolObjects.Num());
+
 	BP_OnFinishSpawningPoolObject(Target, Transform);
 }
 
@@ -67,29 +399,101 @@ void ABasePool::ResetToDefaultValues(UObject* Object)
 		return;
 	}
 	
-	UObject* DefaultObject = Object->GetClass()->GetDefaultObject();
-	bool bImplementsInterface = Object->GetClass()->ImplementsInterface(UPoolInterface::StaticClass());
-	static TArray<FString> EmptyArray;
-	const TArray<FString>& PropertyExcludeList = bImplementsInterface ? IPoolInterface::Execute_GetPropertyResetExcludeList(Object) : EmptyArray;
+	const UObject* DefaultObject = Object->GetClass()->GetDefaultObject();
+	const FPropertyResetPlan& ResetPlan = GetPropertyResetPlan(Object);
+
+	const uint8* DefaultData = reinterpret_cast<const uint8*>(DefaultObject);
+	uint8* ObjectData = reinterpret_cast<uint8*>(Object);
+	for (const FPropertyResetPlan::FMemoryRange& MemoryRange : ResetPlan.MemoryRanges)
+	{
+		FMemory::Memcpy(ObjectData + MemoryRange.Offset, DefaultData + MemoryRange.Offset, MemoryRange.Size);
+	}
 	
-	for (TFieldIterator<FProperty> PropIt(DefaultObject->GetClass()); PropIt; ++PropIt)
+	for (FProperty* Property : ResetPlan.Properties)
+	{
+		// Get the property value from the default object
+		const void* DefaultValue = Property->ContainerPtrToValuePtr<void>(DefaultObject);
+
+		// Set the property value to the default value
+		void* ObjectValue = Property->ContainerPtrToValuePtr<void>(Object);
+		Property->CopyCompleteValue(ObjectValue, DefaultValue);
+	}
+}
+
+const FPropertyResetPlan& ABasePool::GetPropertyResetPlan(UObject* Object)
+{
+	UClass* Class = Object->GetClass();
+
+	// the exclude list is asked to the object every time, it can depend on the instance
+	TArray<FName> PropertyExcludeList;
+	if (Class->ImplementsInterface(UPoolInterface::StaticClass()))
+	{
+		for (const FString& PropertyName : IPoolInterface::Execute_GetPropertyResetExcludeList(Object))
+		{
+			PropertyExcludeList.AddUnique(FName(*PropertyName));
+		}
+		PropertyExcludeList.Sort(FNameLexicalLess());
+	}
+
+	TArray<FPropertyResetPlan, TInlineAllocator<1>>& ClassResetPlans = PropertyResetPlans.FindOrAdd(Class);
+	for (const FPropertyResetPlan& ExistingPlan : ClassResetPlans)
+	{
+		if (ExistingPlan.ExcludedProperties == PropertyExcludeList)
+		{
+			return ExistingPlan;
+		}
+	}
+
+	FPropertyResetPlan& ResetPlan = ClassResetPlans.AddDefaulted_GetRef();
+	ResetPlan.ExcludedProperties = MoveTemp(PropertyExcludeList);
+
+	TArray<FProperty*> MemoryProperties;
+	for (TFieldIterator<FProperty> PropIt(Class); PropIt; ++PropIt)
 	{
 		FProperty* Property = *PropIt;
 		
 		// check if trivially copyable and if it is from our project
 		// we do not want to be resetting variables from base engine classes to avoid unwanted behaviours
-		if (PropertyExcludeList.Contains(Property->GetName()) || !IsClassFromProject(Property->GetOwnerClass()) || !CanResetProperty(Property))
+		if (ResetPlan.ExcludedProperties.Contains(Property->GetFName()) || !IsClassFromProject(Property->GetOwnerClass()) || !CanResetProperty(Property))
 		{
 			continue;
 		}
-		
-		// Get the property value from the default object
-		void* DefaultValue = Property->ContainerPtrToValuePtr<void>(DefaultObject);
 
-		// Set the property value to the default value
-		void* ObjectValue = Property->ContainerPtrToValuePtr<void>(Object);
-		Property->CopyCompleteValue(ObjectValue, DefaultValue);
+		if (CanCopyPropertyMemory(Property))
+		{
+			MemoryProperties.Add(Property);
+		}
+		else
+		{
+			ResetPlan.Properties.Add(Property);
+		}
 	}
+
+	MemoryProperties.Sort([](const FProperty& A, const FProperty& B)
+	{
+		return A.GetOffset_ForInternal() < B.GetOffset_ForInternal();
+	});
+
+	for (const FProperty* Property : MemoryProperties)
+	{
+		const int32 Offset = Property->GetOffset_ForInternal();
+		const int32 Size = Property->GetSize();
+
+		FPropertyResetPlan::FMemoryRange* LastRange = ResetPlan.MemoryRanges.IsEmpty() ? nullptr : &ResetPlan.MemoryRanges.Last();
+		if (LastRange && LastRange->Offset + LastRange->Size == Offset)
+		{
+			LastRange->Size += Size;
+		}
+		else
+		{
+			ResetPlan.MemoryRanges.Add({ Offset, Size });
+		}
+	}
+
+	UE_LOG(LogPoolSubsystem, Verbose, TEXT("Built property reset plan for %s: %d memory ranges, %d properties"),
+		*GetNameSafe(Class), ResetPlan.MemoryRanges.Num(), ResetPlan.Properties.Num());
+	
+	return ResetPlan;
 }
 
 void ABasePool::ReturnToPool(UObject* Object)
@@ -102,57 +506,180 @@ void ABasePool::ReturnToPool(UObject* Object)
 	FLatentActionManager& LatentActionManager = GetWorld()->GetLatentActionManager();
 	LatentActionManager.RemoveActionsForObject(Object);
 	ResetToDefaultValues(Object);
+	UntrackOwnedObject(Object);
 
 	PoolObjects.Add(Object, true);
-	ForceNetUpdate();
+	RequestNetUpdate();
 }
 
-void ABasePool::PreAllocateObjects(TArray<TSoftClassPtr<UObject>> PreAllocastionClasses, int32 PreAllocationNumber)
+void ABasePool::DestroyPoolObject(UObject* Object)
+{
+	check(Object);
+
+	UE_LOG(LogPoolSubsystem, Verbose, TEXT("Destroying pool object %s"), *GetNameSafe(Object));
+
+	if (!PoolObjects.Remove(Object))
+	{
+		return;
+	}
+
+	UntrackOwnedObject(Object);
+
+	if (UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>())
+	{
+		PoolSubsystem->UnregisterPoolObject(Object);
+	}
+
+	RequestNetUpdate();
+}
+
+float ABasePool::GetDemandRate(TSubclassOf<UObject> InClass) const
 {
+	const FPoolClassDemand* Demand = DemandByClass.Find(InClass.Get());
+	return Demand ? Demand->Rate : 0.f;
+}
+
+void ABasePool::UpdateAdaptivePreWarm()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float DeltaTime = Now - LastDemandUpdateTime;
+	LastDemandUpdateTime = Now;
+	if (DeltaTime <= 0.f)
+	{
+		return;
+	}
+
+	// exponential moving average, the weight of the new sample depends on the time it covers so timer hitches do not skew it
+	const float Alpha = 1.f - FMath::Exp(-DeltaTime * UE_LN2 / DemandHalfLife);
+
+	// growth waits for the configured prewarm to finish instead of competing with it
+	UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>();
+	const bool bCanGrow = PoolSubsystem && PoolSubsystem->IsPreWarmComplete();
+
+	for (TPair<TObjectKey<UClass>, FPoolClassDemand>& ClassDemand : DemandByClass)
+	{
+		FPoolClassDemand& Demand = ClassDemand.Value;
+		Demand.Rate += Alpha * (Demand.Acquisitions / DeltaTime - Demand.Rate);
+		Demand.Acquisitions = 0;
+		Demand.TargetFreeCount = FMath::Clamp(FMath::CeilToInt(Demand.Rate * AdaptiveLeadTime), AdaptiveMinFreeObjects, FMath::Max(AdaptiveMinFreeObjects, AdaptiveMaxFreeObjects));
+
+		UClass* Class = ClassDemand.Key.ResolveObjectPtr();
+		if (!bCanGrow || !Class)
+		{
+			continue;
+		}
+
+		const int32 MissingCount = Demand.TargetFreeCount - PoolObjects.NumFreeOfClass(Class) - PoolSubsystem->GetQueuedPreWarmCount(this, Class);
+		if (MissingCount > 0)
+		{
+			// lowest priority, so configured prewarms of pools spawned later still go first
+			PoolSubsystem->QueuePreWarm(this, Class, FMath::Min(MissingCount, AdaptiveMaxGrowthPerUpdate), TNumericLimits<int32>::Lowest(), false);
+		}
+	}
+}
+
+int32 ABasePool::GetKeptFreeCount(const UClass* InClass, bool bUnderMemoryPressure) const
+{
+	if (bUnderMemoryPressure)
+	{
+		return FreeLowWatermark;
+	}
+
+	// the objects grown for the expected demand would only be created again
+	const FPoolClassDemand* Demand = DemandByClass.Find(InClass);
+	return FMath::Max(FreeLowWatermark, Demand ? Demand->TargetFreeCount : 0);
+}
+
+void ABasePool::TrimFreeObjects(bool bUnderMemoryPressure)
+{
+	// removals replicate to the clients, which drop the objects from their copy of the pool
 	if (!HasAuthority())
 	{
 		return;
 	}
 
-	UE_LOG(LogPoolSubsystem, Log, TEXT("Pre allocating objects for pool %s"), *GetNameSafe(this));
-	
-	auto AllocateObjects = [this, PreAllocationNumber](TSubclassOf<UObject> Class)
+	// the watermarks apply to each class on its own, the same way objects are acquired and prewarmed
+	TArray<const UClass*> FreeClasses;
+	PoolObjects.GetFreeClasses(FreeClasses);
+
+	const double IdleSinceTime = FPlatformTime::Seconds() - TrimIdleTime;
+	TArray<UObject*> ObjectsToTrim;
+	for (const UClass* FreeClass : FreeClasses)
 	{
-		UPoolSubsystem* PoolSubsystem = GetWorld()->GetSubsystem<UPoolSubsystem>();
-		for (int i = 0; i < PreAllocationNumber; ++i)
+		TArray<UObject*> FreeObjects;
+		PoolObjects.GetFreeObjectsOldestFirst(FreeClass, FreeObjects);
+		const int32 TrimmableCount = FreeObjects.Num() - GetKeptFreeCount(FreeClass, bUnderMemoryPressure);
+		if (TrimmableCount <= 0)
 		{
-			UObject* SpawnedObject = PoolSubsystem->RequestPoolObject<UObject>(Class, this, false);
-			PoolSubsystem->ReturnToPool(SpawnedObject);
-		}	
-	};
+			continue;
+		}
 
-	if (PreAllocastionClasses.IsEmpty())
+		int32 TrimCount = TrimmableCount;
+		if (!bUnderMemoryPressure)
+		{
+			TrimCount = FreeHighWatermark > 0 ? FreeObjects.Num() - FreeHighWatermark : 0;
+			if (TrimIdleTime > 0.f)
+			{
+				// oldest first, so the idle objects are the first ones of the list
+				TArray<UObject*> IdleObjects;
+				PoolObjects.GetFreeObjectsOldestFirst(FreeClass, IdleObjects, IdleSinceTime);
+				TrimCount = FMath::Max(TrimCount, IdleObjects.Num());
+			}
+
+			TrimCount = FMath::Min(TrimCount, TrimmableCount);
+		}
+
+		if (TrimCount > 0)
+		{
+			ObjectsToTrim.Append(FreeObjects.GetData(), TrimCount);
+		}
+	}
+
+	if (ObjectsToTrim.IsEmpty())
 	{
-		AllocateObjects(TargetClass);
 		return;
 	}
 
-	for (const TSoftClassPtr<UObject>& Class : PreAllocastionClasses)
+	UE_LOG(LogPoolSubsystem, Log, TEXT("Trimming %d free objects from pool %s"), ObjectsToTrim.Num(), *GetNameSafe(this));
+
+	for (UObject* ObjectToTrim : ObjectsToTrim)
 	{
-		AllocateObjects(Class.LoadSynchronous());
+		DestroyPoolObject(ObjectToTrim);
 	}
+
+	PoolObjects.Shrink();
 }
 
-TArray<FString> GetGameFeatureNames()
+void ABasePool::PreAllocateObjects(TArray<TSoftClassPtr<UObject>> PreAllocastionClasses, int32 PreAllocationNumber)
 {
-	TArray<FString> FeatureNames;
-	FString GameFeaturesDir = FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("GameFeatures"));
+	if (!HasAuthority())
+	{
+		return;
+	}
 
-	IFileManager& FileManager = IFileManager::Get();
-	FileManager.FindFilesRecursive(FeatureNames, *GameFeaturesDir, TEXT("*"), false, true);
+	UE_LOG(LogPoolSubsystem, Log, TEXT("Pre allocating objects for pool %s"), *GetNameSafe(this));
+	
+	auto AllocateObjects = [this, PreAllocationNumber](TSubclassOf<UObject> Class)
+	{
+		for (int i = 0; i < PreAllocationNumber; ++i)
+		{
+			PreWarmPoolObject(Class);
+		}	
+	};
 
-	// Trim the full path to just the directory names
-	for (FString& FeatureName : FeatureNames)
+	if (PreAllocastionClasses.IsEmpty())
 	{
-		FeatureName = FPaths::GetCleanFilename(FeatureName);
+		AllocateObjects(TargetClass);
+	}
+	else
+	{
+		for (const TSoftClassPtr<UObject>& Class : PreAllocastionClasses)
+		{
+			AllocateObjects(Class.LoadSynchronous());
+		}
 	}
 
-	return FeatureNames;
+	RequestNetUpdate();
 }
 
 bool ABasePool::IsObjectFree(UObject* InObject)
@@ -183,18 +710,31 @@ bool ABasePool::CanResetProperty(FProperty* Property) const
 			Property->IsA<FStructProperty>() && (Property->PropertyFlags & CPF_IsPlainOldData) && !(Property->PropertyFlags & CPF_Transient);
 }
 
-// Helper function to initialize the Game Feature Names set
-TSet<FString> InitializeGameFeatureNames()
+bool ABasePool::CanCopyPropertyMemory(FProperty* Property) const
 {
-	TSet<FString> FeatureNames;
-	const TArray<FString> GameFeatureNames = GetGameFeatureNames(); // Assume this function retrieves all feature names
+	if (!Property->HasAnyPropertyFlags(CPF_IsPlainOldData))
+	{
+		return false;
+	}
 
-	for (const FString& FeatureName : GameFeatureNames)
+	// bitfields share their bytes with other properties, those have to go through the property mask
+	if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
 	{
-		FeatureNames.Add(FeatureName);
+		return BoolProperty->IsNativeBool();
 	}
 
-	return FeatureNames;
+	return true;
+}
+
+// Helper function to initialize the Game Feature Names set
+TSet<FString> InitializeGameFeatureNames()
+{
+	const UPoolSystemSettings& PoolSystemSettings = *GetDefault<UPoolSystemSettings>();
+	
+	// cooked builds use the names baked into the settings by the editor, so we never scan the disk at runtime
+	const TArray<FString> GameFeatureNames = FPlatformProperties::RequiresCookedData() ? PoolSystemSettings.GameFeatureNames : UPoolSystemSettings::ScanGameFeatureNames();
+	
+	return TSet<FString>(GameFeatureNames);
 }
 
 // Function to extract the feature name from the package name
@@ -224,7 +764,19 @@ bool ABasePool::IsClassFromProject(UClass* Class)
 		return false;
 	}
 
-	FString PackageName = Class->GetPackage()->GetName();
+	if (const bool* bCachedResult = ProjectClassCache.Find(Class))
+	{
+		return *bCachedResult;
+	}
+
+	const bool bIsClassFromProject = IsPackageFromProject(Class->GetPackage()->GetName());
+	ProjectClassCache.Add(Class, bIsClassFromProject);
+	return bIsClassFromProject;
+}
+
+bool ABasePool::IsPackageFromProject(const FString& PackageName)
+{
+	// Same rule in editor and cooked builds, cooked ones read the asset registry serialized by the cook
 	FSoftObjectPath SoftObjectPath(PackageName);
 
 	UAssetManager& AssetManager = UAssetManager::Get();
@@ -22,7 +22,16 @@ UObject* AObjectPoolBase::PreSpawnPoolObject(TSubclassOf<UObject> InClass, AActo
 	UObject* SpawnedObject = NewObject<UObject>(this, InClass);
 	UE_LOG(LogPoolSubsystem, Verbose, TEXT("Spawning new pool object %s"), *GetNameSafe(SpawnedObject));
 	PoolObjects.Add(SpawnedObject, false);
-	ForceNetUpdate();
+	RequestNetUpdate();
+	BP_OnPreSpawnPoolObject(SpawnedObject);
+	return SpawnedObject;
+}
+
+UObject* AObjectPoolBase::PreWarmPoolObject(TSubclassOf<UObject> InClass)
+{
+	UObject* SpawnedObject = NewObject<UObject>(this, InClass);
+	UE_LOG(LogPoolSubsystem, Verbose, TEXT("Prewarming pool object %s"), *GetNameSafe(SpawnedObject));
+	PoolObjects.Add(SpawnedObject, true);
 	BP_OnPreSpawnPoolObject(SpawnedObject);
 	return SpawnedObject;
 }
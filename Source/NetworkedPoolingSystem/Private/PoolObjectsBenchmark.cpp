@@ -0,0 +1,94 @@
+// Copyright JOSEUEM, 2024
+
+#include "PoolObjectsTypes.h"
+#include "Components/ActorComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+
+#if !UE_BUILD_SHIPPING
+
+/* Micro benchmark for the hot FPoolObjectsArray lookups, prints the per operation cost for different pool sizes.
+ * Usage: Pool.Benchmark.ObjectsArray [Iterations]
+ */
+namespace PoolObjectsBenchmark
+{
+	template<typename FunctionType>
+	double MeasureNanosecondsPerOp(const TArray<UObject*>& Objects, int32 Iterations, FunctionType&& Function)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			for (UObject* Object : Objects)
+			{
+				Function(Object);
+			}
+		}
+		const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+		return ElapsedSeconds * 1.0e9 / (static_cast<double>(Objects.Num()) * Iterations);
+	}
+
+	void Run(const TArray<FString>& Args)
+	{
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10;
+		const int32 PoolSizes[] = { 100, 1000, 10000 };
+
+		for (const int32 PoolSize : PoolSizes)
+		{
+			TArray<UObject*> Objects;
+			Objects.Reserve(PoolSize);
+			for (int32 Index = 0; Index < PoolSize; ++Index)
+			{
+				Objects.Add(NewObject<UActorComponent>(GetTransientPackage()));
+			}
+
+			FPoolObjectsArray PoolObjects;
+			for (UObject* Object : Objects)
+			{
+				PoolObjects.Add(Object, true);
+			}
+
+			// keep the results alive so the lookups are not optimized away
+			int32 FoundCount = 0;
+			const double ContainsCost = MeasureNanosecondsPerOp(Objects, Iterations, [&PoolObjects, &FoundCount](UObject* Object)
+			{
+				FoundCount += PoolObjects.Contains(Object) ? 1 : 0;
+			});
+			const double FindCost = MeasureNanosecondsPerOp(Objects, Iterations, [&PoolObjects, &FoundCount](UObject* Object)
+			{
+				FoundCount += PoolObjects.Find(Object).bIsFree ? 1 : 0;
+			});
+			const double AddExistingCost = MeasureNanosecondsPerOp(Objects, Iterations, [&PoolObjects](UObject* Object)
+			{
+				PoolObjects.Add(Object, true);
+			});
+
+			// worst case for a linear scan: everything but the last returned object is in use
+			for (UObject* Object : Objects)
+			{
+				PoolObjects.Add(Object, false);
+			}
+			const TSubclassOf<UObject> ObjectClass = UActorComponent::StaticClass();
+			const double AcquireReturnCost = MeasureNanosecondsPerOp(Objects, Iterations, [&PoolObjects, &ObjectClass](UObject* Object)
+			{
+				PoolObjects.Add(Object, true);
+				PoolObjects.GetFreeObject(ObjectClass);
+			});
+
+			UE_LOG(LogPoolSubsystem, Display, TEXT("FPoolObjectsArray %6d items: Contains %.1f ns/op, Find %.1f ns/op, Add (existing) %.1f ns/op, Return+Acquire %.1f ns/op [%d]"),
+				PoolSize, ContainsCost, FindCost, AddExistingCost, AcquireReturnCost, FoundCount);
+
+			for (UObject* Object : Objects)
+			{
+				Object->MarkAsGarbage();
+			}
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkObjectsArrayCommand(
+		TEXT("Pool.Benchmark.ObjectsArray"),
+		TEXT("Measures the per operation cost of pool object lookups at 100/1k/10k items. Optional argument: iterations"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&Run));
+}
+
+#endif // !UE_BUILD_SHIPPING
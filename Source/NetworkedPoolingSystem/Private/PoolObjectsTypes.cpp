@@ -4,32 +4,113 @@
 
 #include "BasePool.h"
 #include "PoolInterface.h"
+#include "PoolSubsystem.h"
+#include "HAL/PlatformTime.h"
 
 DEFINE_LOG_CATEGORY(LogPoolSubsystem);
 
 FPoolObjectItem& FPoolObjectsArray::Add(UObject* Target, bool bIsFree)
 {
-	if (FPoolObjectItem* ExistingItem = PoolObjects.FindByPredicate([Target](const FPoolObjectItem& Item) { return Item.Object == Target; }))
+	if (bFreeListsDirty)
 	{
-		ExistingItem->bIsFree = bIsFree;
-		MarkItemDirty(*ExistingItem);
-		return *ExistingItem;
+		RebuildFreeLists();
 	}
-	else
+	
+	const int32 ExistingIndex = FindIndex(Target);
+	if (ExistingIndex != INDEX_NONE)
 	{
-		// If not found, add a new item
-		FPoolObjectItem NewItem;
-		NewItem.Object = Target;
-		NewItem.bIsFree = bIsFree;
+		FPoolObjectItem& ExistingItem = PoolObjects[ExistingIndex];
+		if (bIsFree && !ExistingItem.bIsFree)
+		{
+			ExistingItem.FreeSinceTime = FPlatformTime::Seconds();
+		}
+		else if (!bIsFree && ExistingItem.bIsFree)
+		{
+			RecordActivation(ExistingIndex);
+		}
+		ExistingItem.bIsFree = bIsFree;
+		UpdateFreeList(ExistingIndex);
+		UpdateActiveList(ExistingIndex);
+		MarkItemDirty(ExistingItem);
+		return ExistingItem;
+	}
 
-		PoolObjects.Add(MoveTemp(NewItem));
-		MarkItemDirty(NewItem);
-		return PoolObjects.Last();
+	// If not found, add a new item
+	const int32 NewIndex = PoolObjects.AddDefaulted();
+	FPoolObjectItem& NewItem = PoolObjects[NewIndex];
+	NewItem.Object = Target;
+	NewItem.bIsFree = bIsFree;
+	NewItem.FreeSinceTime = FPlatformTime::Seconds();
+	ObjectIndexMap.Add(Target, NewIndex);
+	UpdateFreeList(NewIndex);
+	UpdateActiveList(NewIndex);
+	if (Target)
+	{
+		++NumObjectsByClass.FindOrAdd(Target->GetClass());
 	}
+
+	if (!bIsFree)
+	{
+		RecordActivation(NewIndex);
+	}
+
+	MarkItemDirty(NewItem);
+	return NewItem;
+}
+
+bool FPoolObjectsArray::Remove(UObject* Target)
+{
+	if (bFreeListsDirty)
+	{
+		RebuildFreeLists();
+	}
+
+	const int32 Index = FindIndex(Target);
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	RemoveFromFreeList(Index);
+	RemoveFromActiveList(Index);
+	ObjectIndexMap.Remove(Target);
+	if (int32* NumObjects = NumObjectsByClass.Find(Target->GetClass()))
+	{
+		--(*NumObjects);
+	}
+
+	// the last item is swapped into the removed slot, point its lookups to the new index
+	const int32 LastIndex = PoolObjects.Num() - 1;
+	if (Index != LastIndex)
+	{
+		const FPoolObjectItem& MovedItem = PoolObjects[LastIndex];
+		if (MovedItem.Object)
+		{
+			ObjectIndexMap.Add(MovedItem.Object, Index);
+		}
+
+		// through the listed class, garbage collected objects are still listed until something unlists them
+		if (MovedItem.FreeListSlot != INDEX_NONE)
+		{
+			FreeIndicesByClass.FindChecked(MovedItem.ListedClass)[MovedItem.FreeListSlot] = Index;
+		}
+
+		if (MovedItem.ActiveListSlot != INDEX_NONE)
+		{
+			ActiveIndicesByClass.FindChecked(MovedItem.ListedClass)[MovedItem.ActiveListSlot] = Index;
+		}
+	}
+
+	PoolObjects.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	MarkArrayDirty();
+	return true;
 }
 
 void FPoolObjectsArray::PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize)
 {
+	// removed items are swapped with the last ones, so every stored index past the first removal is stale
+	bObjectIndexDirty = true;
+	bFreeListsDirty = true;
 }
 
 void FPoolObjectsArray::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize)
@@ -39,6 +120,7 @@ void FPoolObjectsArray::PostReplicatedAdd(const TArrayView<int32> AddedIndices,
 	{
 		if (PoolObjects.IsValidIndex(Index))
 		{
+			UpdateReplicatedItem(Index);
 			FPoolObjectItem& Item = PoolObjects[Index];
 			CheckItemPostReplication(Item);
 		}
@@ -52,19 +134,40 @@ void FPoolObjectsArray::PostReplicatedChange(const TArrayView<int32> ChangedIndi
 	{
 		if (PoolObjects.IsValidIndex(Index))
 		{
+			UpdateReplicatedItem(Index);
 			FPoolObjectItem& Item = PoolObjects[Index];
 			CheckItemPostReplication(Item);
 		}
 	}
 }
 
-FPoolObjectItem& FPoolObjectsArray::Find(UObject* Target)
+void FPoolObjectsArray::UpdateReplicatedItem(int32 Index)
 {
-	FPoolObjectItem* FoundItem = PoolObjects.FindByPredicate([Target](const FPoolObjectItem& Item) { return Item.Object == Target; });
+	// a removal earlier in the same update already asked for a full rebuild, which covers this item too
+	if (bObjectIndexDirty || bFreeListsDirty)
+	{
+		return;
+	}
+
+	// new items, or object references resolved after being unmapped
+	FPoolObjectItem& Item = PoolObjects[Index];
+	if (Item.Object && !ObjectIndexMap.Contains(Item.Object))
+	{
+		ObjectIndexMap.Add(Item.Object, Index);
+		++NumObjectsByClass.FindOrAdd(Item.Object->GetClass());
+	}
 
-	if (FoundItem)
+	// free states might have changed
+	UpdateFreeList(Index);
+	UpdateActiveList(Index);
+}
+
+FPoolObjectItem& FPoolObjectsArray::Find(UObject* Target)
+{
+	const int32 FoundIndex = FindIndex(Target);
+	if (FoundIndex != INDEX_NONE)
 	{
-		return *FoundItem;
+		return PoolObjects[FoundIndex];
 	}
 	
 	UE_LOG(LogTemp, Warning, TEXT("Object not found in pool! Returning a default item."));
@@ -74,9 +177,10 @@ FPoolObjectItem& FPoolObjectsArray::Find(UObject* Target)
 
 FPoolObjectItem& FPoolObjectsArray::FindOrAdd(UObject* Target)
 {
-	if (FPoolObjectItem* FoundItem = PoolObjects.FindByPredicate([Target](const FPoolObjectItem& Item) { return Item.Object == Target; }))
+	const int32 FoundIndex = FindIndex(Target);
+	if (FoundIndex != INDEX_NONE)
 	{
-		return *FoundItem;
+		return PoolObjects[FoundIndex];
 	}
 	
 	// If not found, add the object to the pool and return the new item
@@ -103,58 +207,497 @@ bool FPoolObjectsArray::IsFirstSpawn(AActor* Target)
 
 UObject* FPoolObjectsArray::GetFreeObject(TSubclassOf<UObject> Class)
 {
-	// Find the first free object in the pool
-	FPoolObjectItem* FreeItem = PoolObjects.FindByPredicate([Class](const FPoolObjectItem& Item)
+	if (bFreeListsDirty)
 	{
-		return Item.Object && Item.Object->GetClass() == Class && Item.bIsFree;
-	});
+		RebuildFreeLists();
+	}
+
+	TArray<int32>* FreeIndices = FreeIndicesByClass.Find(Class.Get());
+	if (!FreeIndices)
+	{
+		return nullptr;
+	}
+
+	while (FreeIndices->Num() > 0)
+	{
+		const int32 Index = FreeIndices->Pop(EAllowShrinking::No);
+		if (!PoolObjects.IsValidIndex(Index))
+		{
+			continue;
+		}
+
+		FPoolObjectItem& FreeItem = PoolObjects[Index];
+		FreeItem.FreeListSlot = INDEX_NONE;
+
+		// Objects might have been destroyed while waiting in the pool
+		if (FreeItem.Object && FreeItem.bIsFree)
+		{
+			// Mark the object as not free since it's being used
+			FreeItem.bIsFree = false;
+			UpdateActiveList(Index);
+			RecordActivation(Index);
+			MarkItemDirty(FreeItem);
+
+			return FreeItem.Object;
+		}
+	}
+
+	return nullptr;
+}
+
+bool FPoolObjectsArray::HasFreeObject(TSubclassOf<UObject> Class)
+{
+	if (bFreeListsDirty)
+	{
+		RebuildFreeLists();
+	}
+
+	TArray<int32>* FreeIndices = FreeIndicesByClass.Find(Class.Get());
+	if (!FreeIndices)
+	{
+		return false;
+	}
+
+	// drop the destroyed objects GetFreeObject would skip anyway
+	while (FreeIndices->Num() > 0)
+	{
+		const int32 Index = FreeIndices->Last();
+		if (PoolObjects.IsValidIndex(Index) && PoolObjects[Index].Object && PoolObjects[Index].bIsFree)
+		{
+			return true;
+		}
+
+		if (PoolObjects.IsValidIndex(Index))
+		{
+			PoolObjects[Index].FreeListSlot = INDEX_NONE;
+		}
+		FreeIndices->Pop(EAllowShrinking::No);
+	}
 
-	if (FreeItem)
+	return false;
+}
+
+int32 FPoolObjectsArray::NumOfClass(const UClass* Class)
+{
+	if (bFreeListsDirty)
 	{
-		// Mark the object as not free since it's being used
-		FreeItem->bIsFree = false;
-		MarkItemDirty(*FreeItem);
+		RebuildFreeLists();
+	}
+
+	const int32* NumObjects = NumObjectsByClass.Find(Class);
+	return NumObjects ? *NumObjects : 0;
+}
 
-		return FreeItem->Object;
+int32 FPoolObjectsArray::NumFreeOfClass(const UClass* Class)
+{
+	if (bFreeListsDirty)
+	{
+		RebuildFreeLists();
 	}
 
+	const TArray<int32>* FreeIndices = FreeIndicesByClass.Find(Class);
+	return FreeIndices ? FreeIndices->Num() : 0;
+}
+
+void FPoolObjectsArray::GetActiveObjectsOfClass(const UClass* Class, TArray<UObject*>& OutObjects)
+{
+	if (bFreeListsDirty)
+	{
+		RebuildFreeLists();
+	}
+
+	// only the active lists of the class and its children are walked, free objects are never visited
+	for (const TPair<const UClass*, TArray<int32>>& ActiveIndices : ActiveIndicesByClass)
+	{
+		if (ActiveIndices.Value.IsEmpty() || !ActiveIndices.Key->IsChildOf(Class))
+		{
+			continue;
+		}
+
+		OutObjects.Reserve(OutObjects.Num() + ActiveIndices.Value.Num());
+		for (const int32 Index : ActiveIndices.Value)
+		{
+			const FPoolObjectItem& Item = PoolObjects[Index];
+			if (!Item.bIsFree && Item.Object)
+			{
+				OutObjects.Add(Item.Object);
+			}
+		}
+	}
+}
+
+void FPoolObjectsArray::GetActiveSegments(const UClass* Class, FPoolActiveObjectsSegments& OutSegments)
+{
+	if (bFreeListsDirty)
+	{
+		RebuildFreeLists();
+	}
+
+	for (const TPair<const UClass*, TArray<int32>>& ActiveIndices : ActiveIndicesByClass)
+	{
+		if (!ActiveIndices.Value.IsEmpty() && ActiveIndices.Key->IsChildOf(Class))
+		{
+			FPoolActiveObjectsSegment& Segment = OutSegments.AddDefaulted_GetRef();
+			Segment.Objects = this;
+			Segment.Class = ActiveIndices.Key;
+			Segment.Indices = ActiveIndices.Value;
+		}
+	}
+}
+
+UObject* FPoolObjectsArray::GetOldestActiveObject(TSubclassOf<UObject> Class)
+{
+	FActivationQueue* Queue = ActivationQueues.Find(Class.Get());
+	if (!Queue)
+	{
+		return nullptr;
+	}
+
+	// only stale entries are consumed, the recycled one stays at Head until it really went back to the pool
+	for (; Queue->Head < Queue->Entries.Num(); ++Queue->Head)
+	{
+		const TPair<const UObject*, uint32>& Entry = Queue->Entries[Queue->Head];
+		const int32 Index = FindIndex(Entry.Key);
+		if (Index != INDEX_NONE && !PoolObjects[Index].bIsFree && PoolObjects[Index].ActivationSerial == Entry.Value)
+		{
+			return PoolObjects[Index].Object;
+		}
+	}
+
+	Queue->Entries.Reset();
+	Queue->Head = 0;
 	return nullptr;
 }
 
+void FPoolObjectsArray::GetIdleFreeObjects(EPoolObjectTier Tier, double IdleSinceTime, TArray<UObject*>& OutObjects) const
+{
+	for (const FPoolObjectItem& Item : PoolObjects)
+	{
+		if (Item.bIsFree && Item.Object && Item.Tier == Tier && Item.FreeSinceTime <= IdleSinceTime)
+		{
+			OutObjects.Add(Item.Object);
+		}
+	}
+}
+
+void FPoolObjectsArray::GetFreeClasses(TArray<const UClass*>& OutClasses)
+{
+	if (bFreeListsDirty)
+	{
+		RebuildFreeLists();
+	}
+
+	for (const TPair<const UClass*, TArray<int32>>& FreeIndices : FreeIndicesByClass)
+	{
+		if (!FreeIndices.Value.IsEmpty())
+		{
+			OutClasses.Add(FreeIndices.Key);
+		}
+	}
+}
+
+void FPoolObjectsArray::GetFreeObjectsOldestFirst(const UClass* Class, TArray<UObject*>& OutObjects, double IdleSinceTime)
+{
+	if (bFreeListsDirty)
+	{
+		RebuildFreeLists();
+	}
+
+	const TArray<int32>* FreeIndices = FreeIndicesByClass.Find(Class);
+	if (!FreeIndices)
+	{
+		return;
+	}
+
+	TArray<const FPoolObjectItem*, TInlineAllocator<64>> FreeItems;
+	for (const int32 Index : *FreeIndices)
+	{
+		const FPoolObjectItem& Item = PoolObjects[Index];
+		if (Item.bIsFree && Item.Object && Item.FreeSinceTime <= IdleSinceTime)
+		{
+			FreeItems.Add(&Item);
+		}
+	}
+
+	FreeItems.Sort([](const FPoolObjectItem& A, const FPoolObjectItem& B)
+	{
+		return A.FreeSinceTime < B.FreeSinceTime;
+	});
+
+	OutObjects.Reserve(OutObjects.Num() + FreeItems.Num());
+	for (const FPoolObjectItem* Item : FreeItems)
+	{
+		OutObjects.Add(Item->Object);
+	}
+}
+
+void FPoolObjectsArray::Shrink()
+{
+	PoolObjects.Shrink();
+	ObjectIndexMap.Compact();
+	ObjectIndexMap.Shrink();
+
+	for (TMap<const UClass*, TArray<int32>>* IndicesByClass : { &FreeIndicesByClass, &ActiveIndicesByClass })
+	{
+		for (auto It = IndicesByClass->CreateIterator(); It; ++It)
+		{
+			if (It.Value().IsEmpty())
+			{
+				It.RemoveCurrent();
+			}
+			else
+			{
+				It.Value().Shrink();
+			}
+		}
+		IndicesByClass->Compact();
+		IndicesByClass->Shrink();
+	}
+}
+
+EPoolObjectTier FPoolObjectsArray::GetObjectTier(UObject* Target) const
+{
+	const int32 Index = FindIndex(Target);
+	return Index != INDEX_NONE ? PoolObjects[Index].Tier : EPoolObjectTier::Cold;
+}
+
+void FPoolObjectsArray::SetObjectTier(UObject* Target, EPoolObjectTier Tier)
+{
+	// local state only, each machine decides how much of its free objects it keeps ready
+	const int32 Index = FindIndex(Target);
+	if (Index != INDEX_NONE)
+	{
+		PoolObjects[Index].Tier = Tier;
+	}
+}
+
 void FPoolObjectsArray::SetOwningPool(ABasePool* InPool)
 {
 	OwningPool = InPool;
 }
 
+int32 FPoolObjectsArray::FindIndex(const UObject* Target) const
+{
+	if (!Target)
+	{
+		return INDEX_NONE;
+	}
+
+	if (bObjectIndexDirty)
+	{
+		RebuildObjectIndex();
+	}
+
+	const int32* FoundIndex = ObjectIndexMap.Find(Target);
+	if (FoundIndex && PoolObjects.IsValidIndex(*FoundIndex) && PoolObjects[*FoundIndex].Object == Target)
+	{
+		return *FoundIndex;
+	}
+
+	// The index should never be stale at this point, but if it is fall back to a rebuild instead of missing the object
+	if (FoundIndex)
+	{
+		UE_LOG(LogPoolSubsystem, Warning, TEXT("Pool object index was stale for %s, rebuilding"), *GetNameSafe(Target));
+		RebuildObjectIndex();
+		FoundIndex = ObjectIndexMap.Find(Target);
+		return FoundIndex ? *FoundIndex : INDEX_NONE;
+	}
+
+	return INDEX_NONE;
+}
+
+void FPoolObjectsArray::RebuildObjectIndex() const
+{
+	ObjectIndexMap.Reset();
+	ObjectIndexMap.Reserve(PoolObjects.Num());
+	for (int32 Index = 0; Index < PoolObjects.Num(); ++Index)
+	{
+		// unmapped objects on clients will be indexed once they are resolved
+		if (const UObject* Object = PoolObjects[Index].Object)
+		{
+			ObjectIndexMap.Add(Object, Index);
+		}
+	}
+
+	bObjectIndexDirty = false;
+}
+
+void FPoolObjectsArray::UpdateFreeList(int32 Index)
+{
+	FPoolObjectItem& Item = PoolObjects[Index];
+	const bool bIsListed = Item.FreeListSlot != INDEX_NONE;
+	const bool bShouldBeListed = Item.bIsFree && Item.Object;
+
+	if (bIsListed == bShouldBeListed)
+	{
+		return;
+	}
+
+	if (bShouldBeListed)
+	{
+		Item.ListedClass = Item.Object->GetClass();
+		TArray<int32>& FreeIndices = FreeIndicesByClass.FindOrAdd(Item.ListedClass);
+		Item.FreeListSlot = FreeIndices.Add(Index);
+	}
+	else
+	{
+		RemoveFromFreeList(Index);
+	}
+}
+
+void FPoolObjectsArray::RemoveFromFreeList(int32 Index)
+{
+	FPoolObjectItem& Item = PoolObjects[Index];
+	const int32 Slot = Item.FreeListSlot;
+	Item.FreeListSlot = INDEX_NONE;
+
+	TArray<int32>* FreeIndices = Item.ListedClass ? FreeIndicesByClass.Find(Item.ListedClass) : nullptr;
+	if (!FreeIndices || !FreeIndices->IsValidIndex(Slot) || (*FreeIndices)[Slot] != Index)
+	{
+		return;
+	}
+
+	// Only objects taken outside GetFreeObject land here, so swapping out of the stack order is fine
+	FreeIndices->RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	if (FreeIndices->IsValidIndex(Slot))
+	{
+		PoolObjects[(*FreeIndices)[Slot]].FreeListSlot = Slot;
+	}
+}
+
+void FPoolObjectsArray::UpdateActiveList(int32 Index)
+{
+	FPoolObjectItem& Item = PoolObjects[Index];
+	const bool bIsListed = Item.ActiveListSlot != INDEX_NONE;
+	const bool bShouldBeListed = !Item.bIsFree && Item.Object;
+
+	if (bIsListed == bShouldBeListed)
+	{
+		return;
+	}
+
+	if (bShouldBeListed)
+	{
+		Item.ListedClass = Item.Object->GetClass();
+		TArray<int32>& ActiveIndices = ActiveIndicesByClass.FindOrAdd(Item.ListedClass);
+		Item.ActiveListSlot = ActiveIndices.Add(Index);
+	}
+	else
+	{
+		RemoveFromActiveList(Index);
+	}
+}
+
+void FPoolObjectsArray::RemoveFromActiveList(int32 Index)
+{
+	FPoolObjectItem& Item = PoolObjects[Index];
+	const int32 Slot = Item.ActiveListSlot;
+	Item.ActiveListSlot = INDEX_NONE;
+
+	TArray<int32>* ActiveIndices = Item.ListedClass ? ActiveIndicesByClass.Find(Item.ListedClass) : nullptr;
+	if (!ActiveIndices || !ActiveIndices->IsValidIndex(Slot) || (*ActiveIndices)[Slot] != Index)
+	{
+		return;
+	}
+
+	ActiveIndices->RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	if (ActiveIndices->IsValidIndex(Slot))
+	{
+		PoolObjects[(*ActiveIndices)[Slot]].ActiveListSlot = Slot;
+	}
+}
+
+void FPoolObjectsArray::RebuildFreeLists()
+{
+	for (TPair<const UClass*, TArray<int32>>& FreeIndices : FreeIndicesByClass)
+	{
+		FreeIndices.Value.Reset();
+	}
+
+	for (TPair<const UClass*, TArray<int32>>& ActiveIndices : ActiveIndicesByClass)
+	{
+		ActiveIndices.Value.Reset();
+	}
+
+	NumObjectsByClass.Reset();
+	for (int32 Index = 0; Index < PoolObjects.Num(); ++Index)
+	{
+		PoolObjects[Index].FreeListSlot = INDEX_NONE;
+		PoolObjects[Index].ActiveListSlot = INDEX_NONE;
+		UpdateFreeList(Index);
+		UpdateActiveList(Index);
+
+		if (const UObject* Object = PoolObjects[Index].Object)
+		{
+			++NumObjectsByClass.FindOrAdd(Object->GetClass());
+		}
+	}
+
+	bFreeListsDirty = false;
+}
+
+void FPoolObjectsArray::RecordActivation(int32 Index)
+{
+	FPoolObjectItem& Item = PoolObjects[Index];
+	if (!Item.Object)
+	{
+		return;
+	}
+
+	Item.ActivationSerial = NextActivationSerial++;
+
+	FActivationQueue& Queue = ActivationQueues.FindOrAdd(Item.Object->GetClass());
+
+	/* every return leaves a stale entry behind, once they clearly outnumber the objects of the class keep only the
+	 * live ones. At most one entry per object survives so this stays amortized constant */
+	const int32* NumObjects = NumObjectsByClass.Find(Item.Object->GetClass());
+	if (Queue.Entries.Num() >= 64 && Queue.Entries.Num() >= 2 * (NumObjects ? *NumObjects : 0))
+	{
+		int32 LiveCount = 0;
+		for (int32 EntryIndex = Queue.Head; EntryIndex < Queue.Entries.Num(); ++EntryIndex)
+		{
+			const TPair<const UObject*, uint32>& Entry = Queue.Entries[EntryIndex];
+			const int32 EntryItemIndex = FindIndex(Entry.Key);
+			if (EntryItemIndex != INDEX_NONE && !PoolObjects[EntryItemIndex].bIsFree && PoolObjects[EntryItemIndex].ActivationSerial == Entry.Value)
+			{
+				Queue.Entries[LiveCount++] = Entry;
+			}
+		}
+
+		Queue.Entries.SetNum(LiveCount, EAllowShrinking::No);
+		Queue.Head = 0;
+	}
+
+	Queue.Entries.Emplace(Item.Object, Item.ActivationSerial);
+}
+
 void FPoolObjectsArray::CheckItemPostReplication(FPoolObjectItem& Item)
 {
 	// Check if the object changed from free to not free and activate if needed
 	if (Item.Object && OwningPool)
 	{
-		bool bImplementsInterface = Item.Object->GetClass()->ImplementsInterface(UPoolInterface::StaticClass());
+		UPoolSubsystem* PoolSubsystem = OwningPool->GetWorld()->GetSubsystem<UPoolSubsystem>();
+		if (!PoolSubsystem)
+		{
+			return;
+		}
 
 		if (Item.bIsFree)
 		{
-			if (bImplementsInterface)
-			{
-				IPoolInterface::Execute_OnPoolObjectDeactivate(Item.Object);
-			}
+			Item.FreeSinceTime = FPlatformTime::Seconds();
+			PoolSubsystem->NotifyPoolObjectDeactivate(Item.Object);
 			OwningPool.Get()->ReturnToPool(Item.Object);
+			// the pool disabled its components, the next activation has to restore them even if it never spawned here
+			Item.bIsFirstSpawn = false;
 		}
 		else
 		{
-			if (bImplementsInterface)
-			{
-				IPoolInterface::Execute_OnPoolObjectContruct(Item.Object);
-			}
+			PoolSubsystem->NotifyPoolObjectConstruct(Item.Object);
 
 			FTransform ActorTransform = FTransform(Item.Rotation.Rotator(), Item.Location, Item.Scale);
 			OwningPool.Get()->FinishSpawningPoolObject(Item.Object, ActorTransform);
 
-			if (bImplementsInterface)
-			{
-				IPoolInterface::Execute_OnPoolObjectActivate(Item.Object);
-			}
+			PoolSubsystem->NotifyPoolObjectActivate(Item.Object);
 
 			Item.bIsFirstSpawn = false;
 		}
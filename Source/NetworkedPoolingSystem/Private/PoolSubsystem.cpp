@@ -8,6 +8,13 @@
 #include "BasePool.h"
 #include "ObjectPoolBase.h"
 #include "PoolSystemSettings.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "JsonObjectConverter.h"
 
 void UPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
 {
@@ -26,102 +33,1129 @@ void UPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
 	}
 }
 
+void UPoolSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// platforms broadcast the memory trim delegate on their low memory warnings
+	MemoryTrimHandle = FCoreDelegates::GetMemoryTrimDelegate().AddUObject(this, &UPoolSubsystem::OnMemoryTrim);
+	OutOfMemoryHandle = FCoreDelegates::GetOutOfMemoryDelegate().AddUObject(this, &UPoolSubsystem::OnMemoryTrim);
+}
+
+void UPoolSubsystem::Deinitialize()
+{
+	SaveDemandProfile();
+	FCoreDelegates::GetMemoryTrimDelegate().Remove(MemoryTrimHandle);
+	FCoreDelegates::GetOutOfMemoryDelegate().Remove(OutOfMemoryHandle);
+
+	Super::Deinitialize();
+}
+
+void UPoolSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TickPreWarm();
+	TickQueuedRequests();
+	TickPendingActivations();
+
+	// last, so everything requested this frame goes out with this frame net update
+	FlushNetUpdates();
+
+	if (bMemoryTrimRequested.exchange(false))
+	{
+		TrimPools();
+	}
+	else if (ObjectOwningPools.Num() >= ObjectOwningPoolsPruneThreshold)
+	{
+		PruneObjectOwningPools();
+	}
+}
+
+TStatId UPoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPoolSubsystem, STATGROUP_Tickables);
+}
+
+void UPoolSubsystem::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	Super::AddReferencedObjects(InThis, Collector);
+
+	UPoolSubsystem* This = CastChecked<UPoolSubsystem>(InThis);
+	for (FPoolPreWarmTask& Task : This->PreWarmTasks)
+	{
+		UClass* Class = Task.Class.Get();
+		Collector.AddReferencedObject(Class, This);
+	}
+
+	for (FQueuedPoolRequest& QueuedRequest : This->QueuedRequests)
+	{
+		UClass* Class = QueuedRequest.Class.Get();
+		Collector.AddReferencedObject(Class, This);
+	}
+}
+
 bool UPoolSubsystem::IsPooledObjectActive(UObject* Object)
 {
-	if (!Object)
+	if (!Object)
+	{
+		return false;
+	}
+	
+	if (UPoolSubsystem* PoolSubsystem = Object->GetWorld()->GetSubsystem<UPoolSubsystem>())
+	{
+		ABasePool* Pool = PoolSubsystem->FindPool(Object);
+		if (Pool)
+		{
+			return !Pool->IsObjectFree(Object);
+		}
+	}
+	
+	return false;
+}
+
+void UPoolSubsystem::ReturnToPool(UObject* TargetObject)
+{
+	if (!ensure(TargetObject))
+	{
+		return;
+	}
+	
+	if (UPoolSubsystem* PoolSubsystem = TargetObject->GetWorld()->GetSubsystem<UPoolSubsystem>())
+	{
+		if (ABasePool* Pool = PoolSubsystem->FindPool(TargetObject))
+		{
+			// objects still waiting for their activation never got the activate event, so they do not get the deactivate one
+			if (!PoolSubsystem->DropPendingActivation(Pool, TargetObject))
+			{
+				PoolSubsystem->NotifyPoolObjectDeactivate(TargetObject);
+			}
+			Pool->ReturnToPool(TargetObject);
+		}
+		else
+		{
+			UE_LOG(LogPoolSubsystem, Error, TEXT("Tried to return object to pool but did not find owning pool %s"), *GetNameSafe(TargetObject));
+		}
+	}
+}
+
+void UPoolSubsystem::RequestPoolNetUpdate(ABasePool* Pool)
+{
+	++NetUpdateStats.PoolNetUpdatesRequested;
+	PendingPoolNetUpdates.AddUnique(Pool);
+}
+
+void UPoolSubsystem::RequestActorNetUpdate(AActor* Actor, ENetDormancy Dormancy)
+{
+	++NetUpdateStats.ActorNetUpdatesRequested;
+
+	// only the latest dormancy matters, an actor returned and reused within the frame never goes dormant
+	FPendingActorNetUpdate& PendingUpdate = PendingActorNetUpdates.FindOrAdd(Actor);
+	PendingUpdate.Actor = Actor;
+	PendingUpdate.Dormancy = Dormancy;
+}
+
+void UPoolSubsystem::FlushNetUpdates()
+{
+	// moved out first, dormancy changes can call back into game code that requests more updates for the next flush
+	const TMap<TObjectKey<AActor>, FPendingActorNetUpdate> ActorNetUpdates = MoveTemp(PendingActorNetUpdates);
+	PendingActorNetUpdates.Reset();
+	for (const TPair<TObjectKey<AActor>, FPendingActorNetUpdate>& PendingUpdate : ActorNetUpdates)
+	{
+		AActor* Actor = PendingUpdate.Value.Actor.Get();
+		if (!Actor)
+		{
+			continue;
+		}
+
+		if (Actor->NetDormancy != PendingUpdate.Value.Dormancy)
+		{
+			Actor->SetNetDormancy(PendingUpdate.Value.Dormancy);
+			++NetUpdateStats.DormancyChanges;
+		}
+
+		Actor->ForceNetUpdate();
+		++NetUpdateStats.ActorNetUpdatesSent;
+	}
+
+	const TArray<TWeakObjectPtr<ABasePool>> PoolNetUpdates = MoveTemp(PendingPoolNetUpdates);
+	PendingPoolNetUpdates.Reset();
+	for (const TWeakObjectPtr<ABasePool>& PendingPool : PoolNetUpdates)
+	{
+		if (ABasePool* Pool = PendingPool.Get())
+		{
+			Pool->ForceNetUpdate();
+			++NetUpdateStats.PoolNetUpdatesSent;
+		}
+	}
+}
+
+int32 UPoolSubsystem::ReturnAllOwnedBy(AActor* Owner)
+{
+	if (!Owner)
+	{
+		return 0;
+	}
+
+	int32 ReturnedCount = 0;
+	TArray<UObject*> OwnedObjects;
+	for (TArray<ABasePool*>* Pools : { &AuthPools, &ClientPools })
+	{
+		for (ABasePool* Pool : *Pools)
+		{
+			if (Pool && Pool->GetNumActiveObjectsOwnedBy(Owner) > 0)
+			{
+				OwnedObjects.Reset();
+				Pool->GetActiveObjectsOwnedBy(Owner, OwnedObjects);
+				ReturnedCount += ReturnObjectsToPool(Pool, OwnedObjects);
+			}
+		}
+	}
+
+	return ReturnedCount;
+}
+
+int32 UPoolSubsystem::ReturnAllOfClass(TSubclassOf<UObject> Class)
+{
+	if (!Class)
+	{
+		return 0;
+	}
+
+	// child classes might live in their own pools, every pool is checked
+	int32 ReturnedCount = 0;
+	TArray<UObject*> ActiveObjects;
+	for (TArray<ABasePool*>* Pools : { &AuthPools, &ClientPools })
+	{
+		for (ABasePool* Pool : *Pools)
+		{
+			// a pool only holds its target class, and its children when it includes them
+			const UClass* TargetClass = Pool ? Pool->GetTargetclass().Get() : nullptr;
+			if (TargetClass && (TargetClass->IsChildOf(Class) || (Pool->ShouldIncludeChildrenClasses() && Class->IsChildOf(TargetClass))))
+			{
+				ActiveObjects.Reset();
+				Pool->GetActiveObjectsOfClass(Class, ActiveObjects);
+				ReturnedCount += ReturnObjectsToPool(Pool, ActiveObjects);
+			}
+		}
+	}
+
+	return ReturnedCount;
+}
+
+int32 UPoolSubsystem::ReturnObjectsToPool(ABasePool* Pool, TConstArrayView<UObject*> Objects)
+{
+	if (Objects.IsEmpty())
+	{
+		return 0;
+	}
+
+	// the pool is already known, the net updates of the whole batch are coalesced at the end of the frame
+	int32 ReturnedCount = 0;
+	for (UObject* Object : Objects)
+	{
+		// deactivate events of the previous objects might have returned or destroyed this one already
+		if (!IsValid(Object))
+		{
+			continue;
+		}
+
+		const bool bActivationPending = DropPendingActivation(Pool, Object);
+		if (Pool->IsObjectFree(Object))
+		{
+			continue;
+		}
+
+		if (!bActivationPending)
+		{
+			NotifyPoolObjectDeactivate(Object);
+		}
+		Pool->ReturnToPool(Object);
+		++ReturnedCount;
+	}
+
+	return ReturnedCount;
+}
+
+void UPoolSubsystem::InitializePools()
+{
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	const UPoolSystemSettings& PoolSystemSettings = *GetDefault<UPoolSystemSettings>();
+	UE_LOG(LogPoolSubsystem, Log, TEXT("======= Initializing pools ======="));
+
+	FString IsClient = GetWorld()->GetNetMode() == NM_Client ? "Client" : "Server";
+
+	// Spawn generic pools in case we dont want to do special handling on them, they also serve requests while the configured pools load.
+	DefaultActorPool = GetWorld()->SpawnActor<ABasePool>(AActorPoolBase::StaticClass(), SpawnInfo);
+	RegisterPool(DefaultActorPool.Get());
+	UE_LOG(LogPoolSubsystem, Log, TEXT("Spawned pool default actor pool on %s"), *IsClient);
+	DefaultObjectPool = GetWorld()->SpawnActor<ABasePool>(AObjectPoolBase::StaticClass(), SpawnInfo);
+	RegisterPool(DefaultObjectPool.Get());
+	UE_LOG(LogPoolSubsystem, Log, TEXT("Spawned pool default object pool on %s"), *IsClient);
+	
+	// only the authority prewarms, so only its demand is worth keeping
+	if (PoolSystemSettings.bUseDemandProfiles && GetWorld()->GetNetMode() != NM_Client)
+	{
+		LoadDemandProfile();
+	}
+
+	FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
+	for (const FPoolsToSpawn& PoolToSpawn : PoolSystemSettings.Pools)
+	{
+		
+		// we might want to spawn pools only server side.
+		if (!PoolToSpawn.bAuthorityOnly || GetWorld()->GetNetMode() != NM_Client)
+		{
+			if (!ensure(!PoolToSpawn.Class.IsNull()))
+			{
+				continue;
+			}
+			
+			if (!PoolSystemSettings.bAsyncLoadPoolClasses)
+			{
+				SpawnConfiguredPool(PoolToSpawn);
+				continue;
+			}
+			
+			TArray<FSoftObjectPath> ClassesToLoad;
+			ClassesToLoad.Add(PoolToSpawn.Class.ToSoftObjectPath());
+			for (const TSoftClassPtr<UObject>& PreAllocationClass : PoolToSpawn.PreAllocastionClasses)
+			{
+				ClassesToLoad.Add(PreAllocationClass.ToSoftObjectPath());
+			}
+
+			const int32 LoadId = NextPoolLoadId++;
+			FPendingPoolLoad& PendingLoad = PendingPoolLoads.Add(LoadId);
+			PendingLoad.PoolToSpawn = PoolToSpawn;
+			
+			TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(ClassesToLoad, FStreamableDelegate::CreateUObject(this, &UPoolSubsystem::OnPoolClassesLoaded, LoadId));
+
+			// the load might have completed (and been removed) already if everything was in memory
+			if (FPendingPoolLoad* StillPendingLoad = PendingPoolLoads.Find(LoadId))
+			{
+				if (Handle.IsValid())
+				{
+					StillPendingLoad->Handle = Handle;
+				}
+				else
+				{
+					OnPoolClassesLoaded(LoadId);
+				}
+			}
+		}
+	}
+
+	bPoolsInitialized = true;
+	PreWarmProfiledClasses();
+
+	// Without a frame budget everything is prewarmed right away, otherwise Tick takes over
+	TickPreWarm();
+	CheckPreWarmCompleted();
+}
+
+void UPoolSubsystem::OnPoolClassesLoaded(int32 LoadId)
+{
+	FPendingPoolLoad PendingLoad;
+	if (!PendingPoolLoads.RemoveAndCopyValue(LoadId, PendingLoad))
+	{
+		return;
+	}
+
+	SpawnConfiguredPool(PendingLoad.PoolToSpawn);
+	PreWarmProfiledClasses();
+	CheckPreWarmCompleted();
+}
+
+void UPoolSubsystem::SpawnConfiguredPool(const FPoolsToSpawn& PoolToSpawn)
+{
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	FString IsClient = GetWorld()->GetNetMode() == NM_Client ? "Client" : "Server";
+	
+	// already in memory when loaded asynchronously, LoadSynchronous only blocks when async loading is disabled
+	UClass* Class = PoolToSpawn.Class.LoadSynchronous();
+	if (ensure(Class))
+	{
+		ABasePool* Pool = GetWorld()->SpawnActor<ABasePool>(Class, SpawnInfo);
+		UE_LOG(LogPoolSubsystem, Log, TEXT("Spawned pool %s on %s"), *GetNameSafe(Pool), *IsClient);
+		RegisterPool(Pool);
+
+		if (PoolToSpawn.PreAllocastionClasses.IsEmpty())
+		{
+			const int32 PreWarmCount = FMath::Max(PoolToSpawn.PreAllocationNumber, TakeProfiledPreWarmCount(Pool->GetTargetclass()));
+			QueuePreWarm(Pool, Pool->GetTargetclass(), PreWarmCount, PoolToSpawn.PreWarmPriority);
+		}
+		
+		for (const TSoftClassPtr<UObject>& PreAllocationClass : PoolToSpawn.PreAllocastionClasses)
+		{
+			UClass* PreAllocationClassPtr = PreAllocationClass.LoadSynchronous();
+			const int32 PreWarmCount = FMath::Max(PoolToSpawn.PreAllocationNumber, TakeProfiledPreWarmCount(PreAllocationClassPtr));
+			QueuePreWarm(Pool, PreAllocationClassPtr, PreWarmCount, PoolToSpawn.PreWarmPriority);
+		}
+	}
+}
+
+void UPoolSubsystem::FlushPendingPoolLoads()
+{
+	UE_LOG(LogPoolSubsystem, Log, TEXT("Flushing %d pending pool loads"), PendingPoolLoads.Num());
+	
+	TArray<int32> LoadIds;
+	PendingPoolLoads.GenerateKeyArray(LoadIds);
+	for (const int32 LoadId : LoadIds)
+	{
+		if (FPendingPoolLoad* PendingLoad = PendingPoolLoads.Find(LoadId))
+		{
+			if (PendingLoad->Handle.IsValid())
+			{
+				PendingLoad->Handle->WaitUntilComplete();
+			}
+			
+			// no op if the completion delegate already ran while waiting
+			OnPoolClassesLoaded(LoadId);
+		}
+	}
+}
+
+void UPoolSubsystem::LoadDemandProfile()
+{
+	// one file per map, named after its package path so maps with the same name in different folders do not collide
+	const FString MapPath = UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName());
+	DemandProfilePath = FPaths::ProjectSavedDir() / TEXT("PoolProfiles") / MapPath.RightChop(1).Replace(TEXT("/"), TEXT("_")) + TEXT(".json");
+
+	FString ProfileJson;
+	FPoolDemandProfile Profile;
+	if (!FFileHelper::LoadFileToString(ProfileJson, *DemandProfilePath))
+	{
+		return;
+	}
+
+	if (!FJsonObjectConverter::JsonObjectStringToUStruct(ProfileJson, &Profile))
+	{
+		UE_LOG(LogPoolSubsystem, Warning, TEXT("Could not read pool demand profile %s, it will be written again"), *DemandProfilePath);
+		return;
+	}
+
+	for (const FPoolClassDemandProfile& ClassProfile : Profile.Classes)
+	{
+		const int32 PreWarmCount = FMath::RoundToInt(ClassProfile.HighWaterMark);
+		if (ClassProfile.Class.IsNull() || PreWarmCount <= 0)
+		{
+			continue;
+		}
+
+		UE_LOG(LogPoolSubsystem, Verbose, TEXT("Demand profile: %s peaks at %.1f active objects, %d misses last session"), *ClassProfile.Class.ToString(), ClassProfile.HighWaterMark, ClassProfile.MissCount);
+		ProfiledHighWaterMarks.Add(ClassProfile.Class, ClassProfile.HighWaterMark);
+		PendingProfilePreWarms.Add(ClassProfile.Class, PreWarmCount);
+	}
+
+	UE_LOG(LogPoolSubsystem, Log, TEXT("Loaded pool demand profile %s with %d classes"), *DemandProfilePath, ProfiledHighWaterMarks.Num());
+}
+
+void UPoolSubsystem::SaveDemandProfile()
+{
+	if (DemandProfilePath.IsEmpty())
+	{
+		return;
+	}
+
+	// pools still around when the world goes away have not been recorded yet
+	for (ABasePool* Pool : AuthPools)
+	{
+		RecordPoolDemand(Pool);
+	}
+
+	/* the saved marks move towards this session peaks, so one busy session does not inflate the profile forever and classes
+	 * no longer used fade out. Misses mean the prewarmed objects were not enough, those sessions raise the mark right away */
+	const float SessionWeight = GetDefault<UPoolSystemSettings>()->DemandProfileSessionWeight;
+	TMap<FSoftClassPath, FPoolClassDemandProfile> Demand = SessionDemand;
+	for (const TPair<FSoftClassPath, float>& ProfiledHighWaterMark : ProfiledHighWaterMarks)
+	{
+		FPoolClassDemandProfile& ClassProfile = Demand.FindOrAdd(ProfiledHighWaterMark.Key);
+		ClassProfile.Class = ProfiledHighWaterMark.Key;
+		const float WeightedHighWaterMark = FMath::Lerp(ProfiledHighWaterMark.Value, ClassProfile.HighWaterMark, SessionWeight);
+		ClassProfile.HighWaterMark = ClassProfile.MissCount > 0 ? FMath::Max(ClassProfile.HighWaterMark, WeightedHighWaterMark) : WeightedHighWaterMark;
+	}
+
+	FPoolDemandProfile Profile;
+	for (const TPair<FSoftClassPath, FPoolClassDemandProfile>& ClassDemand : Demand)
+	{
+		if (FMath::RoundToInt(ClassDemand.Value.HighWaterMark) > 0)
+		{
+			Profile.Classes.Add(ClassDemand.Value);
+		}
+	}
+	Profile.Classes.Sort([](const FPoolClassDemandProfile& A, const FPoolClassDemandProfile& B)
+	{
+		return A.Class.ToString() < B.Class.ToString();
+	});
+
+	FString ProfileJson;
+	if (FJsonObjectConverter::UStructToJsonObjectString(Profile, ProfileJson) && FFileHelper::SaveStringToFile(ProfileJson, *DemandProfilePath))
+	{
+		UE_LOG(LogPoolSubsystem, Log, TEXT("Saved pool demand profile %s"), *DemandProfilePath);
+	}
+	else
+	{
+		UE_LOG(LogPoolSubsystem, Warning, TEXT("Failed to save pool demand profile %s"), *DemandProfilePath);
+	}
+
+	DemandProfilePath.Reset();
+}
+
+void UPoolSubsystem::RecordPoolDemand(const ABasePool* Pool)
+{
+	if (DemandProfilePath.IsEmpty() || !Pool || !Pool->HasAuthority())
+	{
+		return;
+	}
+
+	for (const TPair<TObjectKey<UClass>, FPoolClassUsage>& ClassUsage : Pool->GetClassUsage())
+	{
+		const UClass* Class = ClassUsage.Key.ResolveObjectPtr();
+		if (!Class)
+		{
+			continue;
+		}
+
+		const FSoftClassPath ClassPath(Class);
+		FPoolClassDemandProfile& ClassDemand = SessionDemand.FindOrAdd(ClassPath);
+		ClassDemand.Class = ClassPath;
+		ClassDemand.HighWaterMark = FMath::Max(ClassDemand.HighWaterMark, static_cast<float>(ClassUsage.Value.HighWaterMark));
+		ClassDemand.MissCount += ClassUsage.Value.MissCount;
+	}
+}
+
+int32 UPoolSubsystem::TakeProfiledPreWarmCount(const UClass* Class)
+{
+	int32 PreWarmCount = 0;
+	if (Class)
+	{
+		PendingProfilePreWarms.RemoveAndCopyValue(FSoftClassPath(Class), PreWarmCount);
+	}
+
+	return PreWarmCount;
+}
+
+void UPoolSubsystem::PreWarmProfiledClasses()
+{
+	// waits for the configured pools, until then FindPool would hand their classes to the generic pools
+	if (PendingProfilePreWarms.IsEmpty() || !PendingPoolLoads.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> ClassesToLoad;
+	for (const TPair<FSoftClassPath, int32>& ProfilePreWarm : PendingProfilePreWarms)
+	{
+		ClassesToLoad.Add(ProfilePreWarm.Key);
+	}
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ClassesToLoad, FStreamableDelegate::CreateUObject(this, &UPoolSubsystem::OnProfiledClassesLoaded));
+	if (!Handle.IsValid())
+	{
+		OnProfiledClassesLoaded();
+	}
+}
+
+void UPoolSubsystem::OnProfiledClassesLoaded()
+{
+	// no op if the load completed right away and was already handled
+	const TMap<FSoftClassPath, int32> ProfilePreWarms = MoveTemp(PendingProfilePreWarms);
+	PendingProfilePreWarms.Reset();
+	for (const TPair<FSoftClassPath, int32>& ProfilePreWarm : ProfilePreWarms)
+	{
+		// classes removed or renamed since the profile was saved are dropped from it on the next save
+		UClass* Class = ProfilePreWarm.Key.ResolveClass();
+		if (ABasePool* Pool = Class ? FindPool(Class) : nullptr)
+		{
+			QueuePreWarm(Pool, Class, ProfilePreWarm.Value);
+		}
+	}
+
+	CheckPreWarmCompleted();
+}
+
+bool UPoolSubsystem::IsDefaultPool(const ABasePool* Pool) const
+{
+	return Pool && (Pool == DefaultActorPool.Get() || Pool == DefaultObjectPool.Get());
+}
+
+void UPoolSubsystem::QueuePreWarm(ABasePool* Pool, TSubclassOf<UObject> Class, int32 Count, int32 Priority, bool bTrackProgress)
+{
+	// only the authority creates pool objects, clients get them replicated
+	if (!Pool || !Class || Count <= 0 || !Pool->HasAuthority())
+	{
+		return;
+	}
+
+	FPoolPreWarmTask Task;
+	Task.Pool = Pool;
+	Task.Class = Class;
+	Task.Remaining = Count;
+	Task.Priority = Priority;
+	Task.bTrackProgress = bTrackProgress;
+
+	const int32 InsertIndex = PreWarmTasks.IndexOfByPredicate([Priority](const FPoolPreWarmTask& Other)
+	{
+		return Other.Priority < Priority;
+	});
+	PreWarmTasks.Insert(MoveTemp(Task), InsertIndex == INDEX_NONE ? PreWarmTasks.Num() : InsertIndex);
+	if (bTrackProgress)
+	{
+		PreWarmQueuedCount += Count;
+	}
+}
+
+int32 UPoolSubsystem::GetQueuedPreWarmCount(const ABasePool* Pool, const UClass* Class) const
+{
+	int32 QueuedCount = 0;
+	for (const FPoolPreWarmTask& Task : PreWarmTasks)
+	{
+		if (Task.Pool.Get() == Pool && Task.Class == Class)
+		{
+			QueuedCount += Task.Remaining;
+		}
+	}
+
+	return QueuedCount;
+}
+
+void UPoolSubsystem::TickPreWarm()
+{
+	if (PreWarmTasks.IsEmpty())
+	{
+		return;
+	}
+
+	const UPoolSystemSettings& PoolSystemSettings = *GetDefault<UPoolSystemSettings>();
+	const double BudgetSeconds = PoolSystemSettings.PreWarmFrameBudgetMs / 1000.0;
+	const double AdaptiveBudgetSeconds = PoolSystemSettings.AdaptivePreWarmFrameBudgetMs / 1000.0;
+	const double StartTime = FPlatformTime::Seconds();
+	double AdaptiveStartTime = 0.0;
+
+	// pools only need one net update per slice, no matter how many objects were created
+	TArray<ABasePool*, TInlineAllocator<8>> PreWarmedPools;
+	while (!PreWarmTasks.IsEmpty())
+	{
+		FPoolPreWarmTask& Task = PreWarmTasks[0];
+
+		// runtime growth always has its own budget, so a demand spike is spread over frames even when prewarming is not
+		if (!Task.bTrackProgress)
+		{
+			const double Now = FPlatformTime::Seconds();
+			if (AdaptiveStartTime == 0.0)
+			{
+				AdaptiveStartTime = Now;
+			}
+			else if (Now - AdaptiveStartTime >= AdaptiveBudgetSeconds)
+			{
+				break;
+			}
+		}
+
+		ABasePool* Pool = Task.Pool.Get();
+		// prewarming stops at the pool size limits, the leftover counts as done
+		if (Pool && Task.Remaining > 0 && !Pool->IsAtCapacity(Task.Class))
+		{
+			Pool->PreWarmPoolObject(Task.Class);
+			PreWarmedPools.AddUnique(Pool);
+			--Task.Remaining;
+			PreWarmCompletedCount += Task.bTrackProgress ? 1 : 0;
+		}
+		else
+		{
+			// pool went away, count its objects as done so the progress can still reach 1
+			PreWarmCompletedCount += Task.bTrackProgress ? FMath::Max(Task.Remaining, 0) : 0;
+			Task.Remaining = 0;
+		}
+
+		if (Task.Remaining <= 0)
+		{
+			PreWarmTasks.RemoveAt(0);
+		}
+
+		if (BudgetSeconds > 0.0 && FPlatformTime::Seconds() - StartTime >= BudgetSeconds)
+		{
+			break;
+		}
+	}
+
+	for (ABasePool* Pool : PreWarmedPools)
+	{
+		Pool->RequestNetUpdate();
+	}
+
+	CheckPreWarmCompleted();
+}
+
+void UPoolSubsystem::CheckPreWarmCompleted()
+{
+	if (!bPreWarmCompletedBroadcast && IsPreWarmComplete())
+	{
+		bPreWarmCompletedBroadcast = true;
+		UE_LOG(LogPoolSubsystem, Log, TEXT("Finished prewarming %d pool objects"), PreWarmCompletedCount);
+		OnPreWarmCompleted.Broadcast();
+	}
+}
+
+float UPoolSubsystem::GetPreWarmProgress() const
+{
+	if (!bPoolsInitialized)
+	{
+		return 0.f;
+	}
+	
+	return PreWarmQueuedCount > 0 ? static_cast<float>(PreWarmCompletedCount) / PreWarmQueuedCount : 1.f;
+}
+
+bool UPoolSubsystem::IsPreWarmComplete() const
+{
+	return bPoolsInitialized && PendingPoolLoads.IsEmpty() && PendingProfilePreWarms.IsEmpty() && !PreWarmTasks.ContainsByPredicate([](const FPoolPreWarmTask& Task)
+	{
+		return Task.bTrackProgress;
+	});
+}
+
+// Number of classes between this class and UObject, used to sort pools from the most derived target class
+static int32 GetClassHierarchyDepth(const UClass* Class)
+{
+	int32 Depth = 0;
+	for (const UStruct* SuperStruct = Class; SuperStruct; SuperStruct = SuperStruct->GetSuperStruct())
 	{
-		return false;
+		++Depth;
 	}
 	
-	if (UPoolSubsystem* PoolSubsystem = Object->GetWorld()->GetSubsystem<UPoolSubsystem>())
+	return Depth;
+}
+
+void UPoolSubsystem::RegisterPool(ABasePool* Pool)
+{
+	if (!ensure(Pool))
 	{
-		ABasePool* Pool = PoolSubsystem->FindPool(Object);
-		if (Pool)
+		return;
+	}
+	
+	/* On authority they are instantly registered, but if we have a replicated pool from the server
+	 * it has to register itself once replicated, see ABasePool::BeginPlay()*/
+	bool bIsClient = GetWorld()->GetNetMode() == NM_Client;
+	bool bIsServerPool = (bIsClient && !Pool->HasAuthority()) || !bIsClient;
+	TArray<ABasePool*>& PoolToUse =  bIsServerPool ? AuthPools : ClientPools;
+	if (ensure(!PoolToUse.Contains(Pool)))
+	{
+		PoolToUse.Add(Pool);
+		/* sort from child classes to parent
+		e.g if you have your custom projectile, you want to find that pool first
+		rather than the generic actor pool. At the same depth the generic pools go last, so configured pools
+		for AActor or UObject still win, the rest keep their registration order */
+		PoolToUse.StableSort([this](const ABasePool& A, const ABasePool& B)
 		{
-			return !Pool->IsObjectFree(Object);
+			const int32 DepthA = GetClassHierarchyDepth(A.GetTargetclass());
+			const int32 DepthB = GetClassHierarchyDepth(B.GetTargetclass());
+			if (DepthA != DepthB)
+			{
+				return DepthA > DepthB;
+			}
+
+			return !IsDefaultPool(&A) && IsDefaultPool(&B);
+		});
+		
+		ResolvedPoolCache.Reset();
+	}
+}
+
+void UPoolSubsystem::UnregisterPool(ABasePool* Pool)
+{
+	if (AuthPools.Remove(Pool) > 0 || ClientPools.Remove(Pool) > 0)
+	{
+		RecordPoolDemand(Pool);
+
+		ResolvedPoolCache.Reset();
+
+		for (auto It = ObjectOwningPools.CreateIterator(); It; ++It)
+		{
+			if (It.Value() == Pool)
+			{
+				It.RemoveCurrent();
+			}
 		}
 	}
-	
-	return false;
 }
 
-void UPoolSubsystem::ReturnToPool(UObject* TargetObject)
+void UPoolSubsystem::UnregisterPoolObject(UObject* Object)
 {
-	if (!ensure(TargetObject))
+	ObjectOwningPools.Remove(Object);
+	CancelPendingActivation(Object);
+}
+
+int32 UPoolSubsystem::RequestPoolObjects(TSubclassOf<UObject> Class, int32 Count, TConstArrayView<FTransform> Transforms, AActor* Owner, TArray<UObject*>& OutObjects)
+{
+	ABasePool* Pool = Count > 0 ? FindPool(Class.Get()) : nullptr;
+	if (!Pool)
+	{
+		UE_CLOG(Count > 0, LogPoolSubsystem, Error, TEXT("Failed to get pool objects %s"), *GetNameSafe(Class));
+		return 0;
+	}
+
+	// pools hand out objects of exactly the requested class, so the interface lookup is shared by the whole batch.
+	// Copied since events requesting other classes may grow the cache
+	const FPoolInterfaceClassInfo ClassInfo = GetInterfaceClassInfo(Class);
+
+	OutObjects.Reserve(OutObjects.Num() + Count);
+	int32 AcquiredCount = 0;
+	for (; AcquiredCount < Count; ++AcquiredCount)
+	{
+		UObject* PoolObject = Pool->AcquirePoolObject(Class, Owner);
+		if (!PoolObject)
+		{
+			break;
+		}
+
+		ObjectOwningPools.Add(PoolObject, Pool);
+		NotifyPoolObjectConstruct(PoolObject, ClassInfo);
+
+		const FTransform& Transform = Transforms.IsValidIndex(AcquiredCount) ? Transforms[AcquiredCount] : FTransform::Identity;
+		Pool->FinishSpawningPoolObject(PoolObject, Transform);
+		NotifyPoolObjectActivate(PoolObject, ClassInfo);
+
+		OutObjects.Add(PoolObject);
+	}
+
+	return AcquiredCount;
+}
+
+TArray<UObject*> UPoolSubsystem::K2_RequestPoolObjects(TSubclassOf<UObject> Class, const TArray<FTransform>& Transforms, AActor* Owner)
+{
+	TArray<UObject*> PoolObjects;
+	RequestPoolObjects(Class, Transforms.Num(), Transforms, Owner, PoolObjects);
+	return PoolObjects;
+}
+
+void UPoolSubsystem::RequestPoolObjectQueued(TSubclassOf<UObject> Class, AActor* Owner, TFunction<void(UObject*)> OnAcquired, bool bDeferred)
+{
+	ABasePool* Pool = FindPool(Class);
+	if (Pool && Pool->GetOverflowPolicy() == EPoolOverflowPolicy::Queue && !Pool->HasFreeObject(Class) && Pool->IsAtCapacity(Class))
 	{
+		Pool->NotifyRequestQueued();
+
+		FQueuedPoolRequest& QueuedRequest = QueuedRequests.AddDefaulted_GetRef();
+		QueuedRequest.Pool = Pool;
+		QueuedRequest.Class = Class;
+		QueuedRequest.Owner = Owner;
+		QueuedRequest.OnAcquired = MoveTemp(OnAcquired);
+		QueuedRequest.bDeferred = bDeferred;
 		return;
 	}
-	
-	if (UPoolSubsystem* PoolSubsystem = TargetObject->GetWorld()->GetSubsystem<UPoolSubsystem>())
+
+	UObject* PoolObject = RequestPoolObject<UObject>(Class, Owner, bDeferred);
+	if (OnAcquired)
 	{
-		if (ABasePool* Pool = PoolSubsystem->FindPool(TargetObject))
+		OnAcquired(PoolObject);
+	}
+}
+
+void UPoolSubsystem::TickQueuedRequests()
+{
+	// callbacks can queue new requests, they are appended so indices stay valid
+	for (int32 Index = 0; Index < QueuedRequests.Num();)
+	{
+		ABasePool* Pool = QueuedRequests[Index].Pool.Get();
+		const TSubclassOf<UObject> Class = QueuedRequests[Index].Class;
+		if (Pool && !Pool->HasFreeObject(Class) && Pool->IsAtCapacity(Class))
 		{
-			bool bImplementsInterface = TargetObject->GetClass()->ImplementsInterface(UPoolInterface::StaticClass());
-		
-			if (bImplementsInterface)
+			++Index;
+			continue;
+		}
+
+		FQueuedPoolRequest QueuedRequest = MoveTemp(QueuedRequests[Index]);
+		QueuedRequests.RemoveAt(Index, 1, EAllowShrinking::No);
+
+		UObject* PoolObject = Pool ? RequestPoolObject<UObject>(Class, QueuedRequest.Owner.Get(), QueuedRequest.bDeferred) : nullptr;
+		if (QueuedRequest.OnAcquired)
+		{
+			QueuedRequest.OnAcquired(PoolObject);
+		}
+	}
+}
+
+UObject* UPoolSubsystem::RequestPoolObjectWithPriority(TSubclassOf<UObject> Class, const FTransform& Transform, AActor* Owner, EPoolActivationPriority Priority)
+{
+	UObject* PoolObject = RequestPoolObject<UObject>(Class, Owner, true);
+	if (!PoolObject)
+	{
+		return nullptr;
+	}
+
+	if (Priority == EPoolActivationPriority::Critical || GetDefault<UPoolSystemSettings>()->ActivationFrameBudgetMs <= 0.f)
+	{
+		return FinishSpawningPoolObject<UObject>(PoolObject, Transform);
+	}
+
+	const uint32 Serial = NextPendingActivationSerial++;
+	PendingActivations.Add(PoolObject, {Transform, Serial});
+	PendingActivationQueues[static_cast<int32>(Priority) - 1].Entries.Emplace(PoolObject, Serial);
+	return PoolObject;
+}
+
+bool UPoolSubsystem::IsActivationPending(UObject* Object) const
+{
+	return PendingActivations.Contains(Object);
+}
+
+bool UPoolSubsystem::CancelPendingActivation(UObject* Object, FTransform* OutTransform)
+{
+	FPendingActivation PendingActivation;
+	if (!PendingActivations.RemoveAndCopyValue(Object, PendingActivation))
+	{
+		return false;
+	}
+
+	if (OutTransform)
+	{
+		*OutTransform = PendingActivation.Transform;
+	}
+	return true;
+}
+
+bool UPoolSubsystem::DropPendingActivation(ABasePool* Pool, UObject* Object)
+{
+	FTransform PendingTransform;
+	if (!CancelPendingActivation(Object, &PendingTransform))
+	{
+		return false;
+	}
+
+	// objects created for the request are still half constructed, finish them so the pool can park them
+	if (!Pool->DoesObjectBelongsToPool(Object))
+	{
+		Pool->FinishSpawningPoolObject(Object, PendingTransform);
+	}
+	return true;
+}
+
+void UPoolSubsystem::TickPendingActivations()
+{
+	const double BudgetSeconds = GetDefault<UPoolSystemSettings>()->ActivationFrameBudgetMs / 1000.0;
+	const double StartTime = FPlatformTime::Seconds();
+	bool bOutOfBudget = false;
+
+	for (FPendingActivationQueue& Queue : PendingActivationQueues)
+	{
+		// activations can request more objects, new entries are appended so Head stays valid
+		while (!bOutOfBudget && Queue.Head < Queue.Entries.Num())
+		{
+			const TPair<TWeakObjectPtr<UObject>, uint32> Entry = Queue.Entries[Queue.Head++];
+			UObject* Object = Entry.Key.Get();
+			const FPendingActivation* PendingActivation = Object ? PendingActivations.Find(Object) : nullptr;
+			if (!PendingActivation || PendingActivation->Serial != Entry.Value)
 			{
-				IPoolInterface::Execute_OnPoolObjectDeactivate(TargetObject);
+				continue;
 			}
-			
-			Pool->ReturnToPool(TargetObject);
+
+			const FTransform Transform = PendingActivation->Transform;
+			PendingActivations.Remove(Object);
+			FinishSpawningPoolObject<UObject>(Object, Transform);
+
+			// at least one activation per frame so the queues always move forward
+			bOutOfBudget = BudgetSeconds > 0.0 && FPlatformTime::Seconds() - StartTime >= BudgetSeconds;
 		}
-		else
+
+		if (Queue.Head > 0 && Queue.Head * 2 >= Queue.Entries.Num())
 		{
-			UE_LOG(LogPoolSubsystem, Error, TEXT("Tried to return object to pool but did not find owning pool %s"), *GetNameSafe(TargetObject));
+			Queue.Entries.RemoveAt(0, Queue.Head, EAllowShrinking::No);
+			Queue.Head = 0;
 		}
 	}
 }
 
-void UPoolSubsystem::InitializePools()
+void UPoolSubsystem::GetActivePoolObjects(TSubclassOf<UObject> Class, TArray<UObject*>& OutObjects)
 {
-	FActorSpawnParameters SpawnInfo;
-	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-	const UPoolSystemSettings& PoolSystemSettings = *GetDefault<UPoolSystemSettings>();
-	UE_LOG(LogPoolSubsystem, Log, TEXT("======= Initializing pools ======="));
+	OutObjects.Reset();
+	for (UObject* Object : GetActivePoolObjects<UObject>(Class))
+	{
+		OutObjects.Add(Object);
+	}
+}
 
-	FString IsClient = GetWorld()->GetNetMode() == NM_Client ? "Client" : "Server";
-	for (const FPoolsToSpawn& PoolToSpawn : PoolSystemSettings.Pools)
+int32 UPoolSubsystem::GetNumActivePoolObjects(TSubclassOf<UObject> Class)
+{
+	FPoolActiveObjectsSegments Segments;
+	GetActiveObjectSegments(Class.Get(), Segments);
+
+	int32 NumActive = 0;
+	for (const FPoolActiveObjectsSegment& Segment : Segments)
 	{
-		
-		// we might want to spawn pools only server side.
-		if (!PoolToSpawn.bAuthorityOnly || GetWorld()->GetNetMode() != NM_Client)
+		NumActive += Segment.Indices.Num();
+	}
+
+	return NumActive;
+}
+
+UObject* UPoolSubsystem::GetActivePoolObjectAt(TSubclassOf<UObject> Class, int32 Index)
+{
+	FPoolActiveObjectsSegments Segments;
+	GetActiveObjectSegments(Class.Get(), Segments);
+
+	for (const FPoolActiveObjectsSegment& Segment : Segments)
+	{
+		if (Segment.Indices.IsValidIndex(Index))
+		{
+			return Segment.Objects->GetActiveObjectAt(Segment.Class, Segment.Indices[Index], Index);
+		}
+
+		Index -= Segment.Indices.Num();
+	}
+
+	return nullptr;
+}
+
+void UPoolSubsystem::GetActiveObjectSegments(const UClass* Class, FPoolActiveObjectsSegments& OutSegments)
+{
+	if (!Class)
+	{
+		return;
+	}
+
+	for (TArray<ABasePool*>* Pools : { &AuthPools, &ClientPools })
+	{
+		for (ABasePool* Pool : *Pools)
 		{
-			UClass* Class = PoolToSpawn.Class.LoadSynchronous();
-			if (ensure(Class))
+			if (Pool)
 			{
-				ABasePool* Pool = GetWorld()->SpawnActor<ABasePool>(Class, SpawnInfo);
-				UE_LOG(LogPoolSubsystem, Log, TEXT("Spawned pool %s on %s"), *GetNameSafe(Pool), *IsClient);
-				RegisterPool(Pool);
-				Pool->PreAllocateObjects(PoolToSpawn.PreAllocastionClasses, PoolToSpawn.PreAllocationNumber);
+				Pool->GetActiveObjectSegments(Class, OutSegments);
 			}
 		}
 	}
+}
 
-	// Spawn generic pools in case we dont want to do special handling on them.
-	RegisterPool(GetWorld()->SpawnActor<ABasePool>(AActorPoolBase::StaticClass(), SpawnInfo));
-	UE_LOG(LogPoolSubsystem, Log, TEXT("Spawned pool default actor pool on %s"), *IsClient);
-	RegisterPool(GetWorld()->SpawnActor<ABasePool>(AObjectPoolBase::StaticClass(), SpawnInfo));
-	UE_LOG(LogPoolSubsystem, Log, TEXT("Spawned pool default object pool on %s"), *IsClient);
+FPoolOverflowStats UPoolSubsystem::GetPoolOverflowStats(TSubclassOf<UObject> Class)
+{
+	const ABasePool* Pool = FindPool(Class.Get());
+	return Pool ? Pool->GetOverflowStats() : FPoolOverflowStats();
 }
 
-void UPoolSubsystem::RegisterPool(ABasePool* Pool)
+void UPoolSubsystem::TrimPools()
 {
-	/* On authority they are instantly registered, but if we have a replicated pool from the server
-	 * it has to register itself once replicated, see ABasePool::BeginPlay()*/
-	bool bIsClient = GetWorld()->GetNetMode() == NM_Client;
-	bool bIsServerPool = (bIsClient && !Pool->HasAuthority()) || !bIsClient;
-	TArray<ABasePool*>& PoolToUse =  bIsServerPool ? AuthPools : ClientPools;
-	if (ensure(Pool) && ensure(!PoolToUse.Contains(Pool)))
+	UE_LOG(LogPoolSubsystem, Log, TEXT("Trimming pools"));
+
+	for (ABasePool* Pool : AuthPools)
 	{
-		PoolToUse.Add(Pool);
-		/* sort from child classes to parent
-		e.g if you have your custom projectile, you want to find that pool first
-		rather than the generic actor pool */
-		PoolToUse.Sort([](ABasePool& A, ABasePool& B)
+		if (Pool)
 		{
-			return A.GetTargetclass()->IsChildOf(B.GetTargetclass());
-		});
+			Pool->TrimFreeObjects(true);
+		}
+	}
+
+	for (ABasePool* Pool : ClientPools)
+	{
+		if (Pool)
+		{
+			Pool->TrimFreeObjects(true);
+		}
+	}
+
+	PruneObjectOwningPools();
+}
+
+void UPoolSubsystem::PruneObjectOwningPools()
+{
+	for (auto It = ObjectOwningPools.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
 	}
+
+	ObjectOwningPools.Compact();
+	// amortized, a map that keeps growing with live objects is only walked again once it doubled
+	ObjectOwningPoolsPruneThreshold = FMath::Max(256, ObjectOwningPools.Num() * 2);
+}
+
+void UPoolSubsystem::OnMemoryTrim()
+{
+	// handled on the next tick, pools can only be touched from the game thread
+	bMemoryTrimRequested = true;
+}
+
+void UPoolSubsystem::NotifyPoolObjectConstruct(UObject* Object)
+{
+	NotifyPoolObjectConstruct(Object, GetInterfaceClassInfo(Object->GetClass()));
+}
+
+void UPoolSubsystem::NotifyPoolObjectConstruct(UObject* Object, const FPoolInterfaceClassInfo& ClassInfo)
+{
+	if (ClassInfo.bNativeConstruct)
+	{
+		static_cast<IPoolInterface*>(Object->GetNativeInterfaceAddress(UPoolInterface::StaticClass()))->OnPoolObjectContruct_Implementation();
+	}
+	else if (ClassInfo.bImplementsInterface)
+	{
+		IPoolInterface::Execute_OnPoolObjectContruct(Object);
+	}
+}
+
+void UPoolSubsystem::NotifyPoolObjectActivate(UObject* Object)
+{
+	NotifyPoolObjectActivate(Object, GetInterfaceClassInfo(Object->GetClass()));
+}
+
+void UPoolSubsystem::NotifyPoolObjectActivate(UObject* Object, const FPoolInterfaceClassInfo& ClassInfo)
+{
+	if (ClassInfo.bNativeActivate)
+	{
+		static_cast<IPoolInterface*>(Object->GetNativeInterfaceAddress(UPoolInterface::StaticClass()))->OnPoolObjectActivate_Implementation();
+	}
+	else if (ClassInfo.bImplementsInterface)
+	{
+		IPoolInterface::Execute_OnPoolObjectActivate(Object);
+	}
+}
+
+void UPoolSubsystem::NotifyPoolObjectDeactivate(UObject* Object)
+{
+	NotifyPoolObjectDeactivate(Object, GetInterfaceClassInfo(Object->GetClass()));
+}
+
+void UPoolSubsystem::NotifyPoolObjectDeactivate(UObject* Object, const FPoolInterfaceClassInfo& ClassInfo)
+{
+	if (ClassInfo.bNativeDeactivate)
+	{
+		static_cast<IPoolInterface*>(Object->GetNativeInterfaceAddress(UPoolInterface::StaticClass()))->OnPoolObjectDeactivate_Implementation();
+	}
+	else if (ClassInfo.bImplementsInterface)
+	{
+		IPoolInterface::Execute_OnPoolObjectDeactivate(Object);
+	}
+}
+
+const FPoolInterfaceClassInfo& UPoolSubsystem::GetInterfaceClassInfo(UClass* Class)
+{
+	if (const FPoolInterfaceClassInfo* CachedInfo = InterfaceClassInfoCache.Find(Class))
+	{
+		return *CachedInfo;
+	}
+
+	FPoolInterfaceClassInfo ClassInfo;
+	ClassInfo.bImplementsInterface = Class->ImplementsInterface(UPoolInterface::StaticClass());
+	
+	// Interfaces only implemented in Blueprint have no native address, those always go through the generated Execute_ functions
+	const bool bHasNativeInterface = ClassInfo.bImplementsInterface && Class->GetDefaultObject()->GetNativeInterfaceAddress(UPoolInterface::StaticClass()) != nullptr;
+	if (bHasNativeInterface)
+	{
+		// A hook is native unless a Blueprint overrides the event, same check the Execute_ functions do through FindFunction
+		auto IsNativeHook = [Class](FName FunctionName)
+		{
+			const UFunction* Function = Class->FindFunctionByName(FunctionName);
+			return !Function || Function->HasAnyFunctionFlags(FUNC_Native);
+		};
+
+		ClassInfo.bNativeConstruct = IsNativeHook(GET_FUNCTION_NAME_CHECKED(IPoolInterface, OnPoolObjectContruct));
+		ClassInfo.bNativeActivate = IsNativeHook(GET_FUNCTION_NAME_CHECKED(IPoolInterface, OnPoolObjectActivate));
+		ClassInfo.bNativeDeactivate = IsNativeHook(GET_FUNCTION_NAME_CHECKED(IPoolInterface, OnPoolObjectDeactivate));
+	}
+
+	return InterfaceClassInfoCache.Add(Class, ClassInfo);
 }
 
 AActor* UPoolSubsystem::K2_BeginSpawningPoolActor(const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass, const FTransform& SpawnTransform, AActor* Owner /*= nullptr*/, ESpawnActorScaleMethod TransformScaleMethod /*= ESpawnActorScaleMethod::MultiplyWithRoot*/)
@@ -232,12 +1266,41 @@ ABasePool* UPoolSubsystem::FindClassInPool(TSubclassOf<UObject> Class, TArray<AB
 
 ABasePool* UPoolSubsystem::FindPool(UClass* Class)
 {
+	if (!Class)
+	{
+		return nullptr;
+	}
+	
+	if (ABasePool** CachedPool = ResolvedPoolCache.Find(Class))
+	{
+		return *CachedPool;
+	}
+	
 	TArray<ABasePool*>& PoolToUse =  GetWorld()->GetNetMode() == NM_Client ? ClientPools : AuthPools;
-	return FindClassInPool(Class, PoolToUse);
+	ABasePool* Pool = FindClassInPool(Class, PoolToUse);
+
+	// the dedicated pool for this class might still be loading, the generic pools serve it meanwhile unless we are told to wait
+	if (!PendingPoolLoads.IsEmpty() && (!Pool || IsDefaultPool(Pool)))
+	{
+		const UPoolSystemSettings& PoolSystemSettings = *GetDefault<UPoolSystemSettings>();
+		if (PoolSystemSettings.PendingPoolFallback == EPoolLoadingFallback::FlushLoading)
+		{
+			FlushPendingPoolLoads();
+			Pool = FindClassInPool(Class, PoolToUse);
+		}
+	}
+	
+	ResolvedPoolCache.Add(Class, Pool);
+	return Pool;
 }
 
 ABasePool* UPoolSubsystem::FindPool(UObject* Target)
 {
+	if (ABasePool** OwningPool = ObjectOwningPools.Find(Target))
+	{
+		return *OwningPool;
+	}
+	
 	AActor* TargetActor = Cast<AActor>(Target);
 
 	if (!TargetActor)
@@ -250,16 +1313,16 @@ ABasePool* UPoolSubsystem::FindPool(UObject* Target)
 		return Pool->DoesObjectBelongsToPool(Target);
 	};
 	
+	// Slow path for objects we have not seen acquired yet, e.g actors replicated from server pools
 	ABasePool** Pool = AuthPools.FindByPredicate(FindPoolForObject);
-
-	if (Pool)
+	if (!Pool)
 	{
-		return *Pool;
+		Pool = ClientPools.FindByPredicate(FindPoolForObject);
 	}
 	
-	Pool = ClientPools.FindByPredicate(FindPoolForObject);
 	if (Pool)
 	{
+		ObjectOwningPools.Add(Target, *Pool);
 		return *Pool;
 	}
 
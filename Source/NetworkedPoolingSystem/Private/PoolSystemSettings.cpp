@@ -2,9 +2,42 @@
 
 
 #include "PoolSystemSettings.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
 
 UPoolSystemSettings::UPoolSystemSettings(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
 {
 	
 }
+
+TArray<FString> UPoolSystemSettings::ScanGameFeatureNames()
+{
+	TArray<FString> FeatureNames;
+	FString GameFeaturesDir = FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("GameFeatures"));
+
+	IFileManager& FileManager = IFileManager::Get();
+	FileManager.FindFilesRecursive(FeatureNames, *GameFeaturesDir, TEXT("*"), false, true);
+
+	// Trim the full path to just the directory names
+	for (FString& FeatureName : FeatureNames)
+	{
+		FeatureName = FPaths::GetCleanFilename(FeatureName);
+	}
+
+	return FeatureNames;
+}
+
+#if WITH_EDITOR
+void UPoolSystemSettings::RefreshGameFeatureNames()
+{
+	TArray<FString> FeatureNames = ScanGameFeatureNames();
+	FeatureNames.Sort();
+
+	if (FeatureNames != GameFeatureNames)
+	{
+		GameFeatureNames = MoveTemp(FeatureNames);
+		TryUpdateDefaultConfigFile();
+	}
+}
+#endif
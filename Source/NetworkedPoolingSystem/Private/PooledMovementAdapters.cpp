@@ -0,0 +1,183 @@
+// Copyright JOSEUEM, 2024
+
+#include "PooledMovementAdapters.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "GameFramework/RotatingMovementComponent.h"
+#include "Components/InterpToMovementComponent.h"
+
+class FProjectileMovementAdapter : public IPooledMovementAdapter
+{
+public:
+	virtual UClass* GetMovementComponentClass() const override
+	{
+		return UProjectileMovementComponent::StaticClass();
+	}
+
+	virtual void ResetMovement(UMovementComponent* MovementComponent, AActor* Actor) const override
+	{
+		// A projectile that stopped simulating has lost its velocity, bring back the one from its template
+		UProjectileMovementComponent* ProjMoveComp = static_cast<UProjectileMovementComponent*>(MovementComponent);
+		if (const UProjectileMovementComponent* Archetype = Cast<UProjectileMovementComponent>(ProjMoveComp->GetArchetype()))
+		{
+			ProjMoveComp->Velocity = Archetype->Velocity;
+		}
+	}
+
+	virtual void ReactivateMovement(UMovementComponent* MovementComponent, AActor* Actor) const override
+	{
+		UProjectileMovementComponent* ProjMoveComp = static_cast<UProjectileMovementComponent*>(MovementComponent);
+		ProjMoveComp->SetUpdatedComponent(Actor->GetRootComponent());
+		if (ProjMoveComp->Velocity.SizeSquared() > 0.f)
+		{
+			// InitialSpeed > 0 overrides initial velocity magnitude.
+			if (ProjMoveComp->InitialSpeed > 0.f)
+			{
+				ProjMoveComp->Velocity = ProjMoveComp->Velocity.GetSafeNormal() * ProjMoveComp->InitialSpeed;
+			}
+
+			if (ProjMoveComp->bInitialVelocityInLocalSpace)
+			{
+				ProjMoveComp->SetVelocityInLocalSpace(ProjMoveComp->Velocity);
+			}
+
+			if (ProjMoveComp->bRotationFollowsVelocity)
+			{
+				if (ProjMoveComp->UpdatedComponent)
+				{
+					FRotator DesiredRotation = ProjMoveComp->Velocity.Rotation();
+					if (ProjMoveComp->bRotationRemainsVertical)
+					{
+						DesiredRotation.Pitch = 0.0f;
+						DesiredRotation.Yaw = FRotator::NormalizeAxis(DesiredRotation.Yaw);
+						DesiredRotation.Roll = 0.0f;
+					}
+
+					ProjMoveComp->UpdatedComponent->SetWorldRotation(DesiredRotation);
+				}
+			}
+
+			ProjMoveComp->UpdateComponentVelocity();
+
+			if (ProjMoveComp->UpdatedPrimitive && ProjMoveComp->UpdatedPrimitive->IsSimulatingPhysics())
+			{
+				ProjMoveComp->UpdatedPrimitive->SetPhysicsLinearVelocity(ProjMoveComp->Velocity);
+			}
+		}
+	}
+};
+
+class FRotatingMovementAdapter : public IPooledMovementAdapter
+{
+public:
+	virtual UClass* GetMovementComponentClass() const override
+	{
+		return URotatingMovementComponent::StaticClass();
+	}
+
+	virtual void ReactivateMovement(UMovementComponent* MovementComponent, AActor* Actor) const override
+	{
+		// rotation is driven by the rate only, it just needs something to rotate
+		if (!MovementComponent->UpdatedComponent)
+		{
+			MovementComponent->SetUpdatedComponent(Actor->GetRootComponent());
+		}
+	}
+};
+
+class FInterpToMovementAdapter : public IPooledMovementAdapter
+{
+public:
+	virtual UClass* GetMovementComponentClass() const override
+	{
+		return UInterpToMovementComponent::StaticClass();
+	}
+
+	virtual void ResetMovement(UMovementComponent* MovementComponent, AActor* Actor) const override
+	{
+		MovementComponent->StopMovementImmediately();
+	}
+
+	virtual void ReactivateMovement(UMovementComponent* MovementComponent, AActor* Actor) const override
+	{
+		// relative control points are computed from the start location, which changed with the new spawn transform
+		UInterpToMovementComponent* InterpComp = static_cast<UInterpToMovementComponent*>(MovementComponent);
+		InterpComp->SetUpdatedComponent(Actor->GetRootComponent());
+		InterpComp->FinaliseControlPoints();
+		InterpComp->RestartMovement();
+	}
+};
+
+class FCharacterMovementAdapter : public IPooledMovementAdapter
+{
+public:
+	virtual UClass* GetMovementComponentClass() const override
+	{
+		return UCharacterMovementComponent::StaticClass();
+	}
+
+	virtual void ResetMovement(UMovementComponent* MovementComponent, AActor* Actor) const override
+	{
+		UCharacterMovementComponent* CharacterMoveComp = static_cast<UCharacterMovementComponent*>(MovementComponent);
+		CharacterMoveComp->StopMovementImmediately();
+		CharacterMoveComp->ClearAccumulatedForces();
+	}
+
+	virtual void ReactivateMovement(UMovementComponent* MovementComponent, AActor* Actor) const override
+	{
+		UCharacterMovementComponent* CharacterMoveComp = static_cast<UCharacterMovementComponent*>(MovementComponent);
+		if (!CharacterMoveComp->UpdatedComponent)
+		{
+			CharacterMoveComp->SetUpdatedComponent(Actor->GetRootComponent());
+		}
+
+		// start over from the default mode instead of whatever the character was doing when it was returned
+		CharacterMoveComp->SetDefaultMovementMode();
+	}
+};
+
+FPooledMovementAdapterRegistry& FPooledMovementAdapterRegistry::Get()
+{
+	static FPooledMovementAdapterRegistry Registry;
+	return Registry;
+}
+
+FPooledMovementAdapterRegistry::FPooledMovementAdapterRegistry()
+{
+	RegisterAdapter(MakeShared<FProjectileMovementAdapter>());
+	RegisterAdapter(MakeShared<FRotatingMovementAdapter>());
+	RegisterAdapter(MakeShared<FInterpToMovementAdapter>());
+	RegisterAdapter(MakeShared<FCharacterMovementAdapter>());
+}
+
+void FPooledMovementAdapterRegistry::RegisterAdapter(const TSharedRef<IPooledMovementAdapter>& Adapter)
+{
+	Adapters.AddUnique(Adapter);
+}
+
+void FPooledMovementAdapterRegistry::UnregisterAdapter(const TSharedRef<IPooledMovementAdapter>& Adapter)
+{
+	Adapters.Remove(Adapter);
+}
+
+TSharedPtr<IPooledMovementAdapter> FPooledMovementAdapterRegistry::FindAdapter(const UClass* MovementComponentClass) const
+{
+	TSharedPtr<IPooledMovementAdapter> BestAdapter;
+	for (const TSharedRef<IPooledMovementAdapter>& Adapter : Adapters)
+	{
+		UClass* AdapterClass = Adapter->GetMovementComponentClass();
+		if (!MovementComponentClass->IsChildOf(AdapterClass))
+		{
+			continue;
+		}
+
+		// keep the most derived one, later registrations win on the same class so projects can override the defaults
+		if (!BestAdapter.IsValid() || AdapterClass->IsChildOf(BestAdapter->GetMovementComponentClass()))
+		{
+			BestAdapter = Adapter;
+		}
+	}
+
+	return BestAdapter;
+}
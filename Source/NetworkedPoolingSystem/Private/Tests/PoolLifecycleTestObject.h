@@ -0,0 +1,24 @@
+// Copyright JOSEUEM, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PoolInterface.h"
+#include "PoolLifecycleTestObject.generated.h"
+
+// Counts the IPoolInterface events it receives, only used by the automation tests
+UCLASS(NotBlueprintable, HideDropdown, Transient)
+class UPoolLifecycleTestObject : public UObject, public IPoolInterface
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnPoolObjectContruct_Implementation() override { ++NumConstructs; }
+	virtual void OnPoolObjectActivate_Implementation() override { ++NumActivations; }
+	virtual void OnPoolObjectDeactivate_Implementation() override { ++NumDeactivations; }
+	virtual TArray<FString> GetPropertyResetExcludeList_Implementation() override { return {}; }
+
+	int32 NumConstructs = 0;
+	int32 NumActivations = 0;
+	int32 NumDeactivations = 0;
+};
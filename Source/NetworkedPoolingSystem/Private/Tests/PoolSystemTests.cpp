@@ -0,0 +1,130 @@
+// Copyright JOSEUEM, 2024
+
+#include "ActorPoolBase.h"
+#include "PoolObjectsTypes.h"
+#include "PoolSubsystem.h"
+#include "PoolSystemSettings.h"
+#include "Tests/PoolLifecycleTestObject.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/DefaultPawn.h"
+#include "GameFramework/GameStateBase.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace PoolSystemTests
+{
+	UWorld* CreateTestWorld()
+	{
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+		return World;
+	}
+
+	void DestroyTestWorld(UWorld* World)
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	// The subsystem spawns its pools once the world has a game state
+	UPoolSubsystem* InitializePoolSubsystem(UWorld* World)
+	{
+		World->SetGameState(World->SpawnActor<AGameStateBase>());
+		return World->GetSubsystem<UPoolSubsystem>();
+	}
+
+	// Pools spawned as if they were replicated from a server
+	template<typename PoolType>
+	PoolType* SpawnClientPool(UWorld* World)
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.bDeferConstruction = true;
+		PoolType* Pool = World->SpawnActor<PoolType>(SpawnParameters);
+		Pool->SetRole(ROLE_SimulatedProxy);
+		Pool->FinishSpawning(FTransform::Identity);
+		return Pool;
+	}
+
+	// Protected on the pools, the tests drive the replication callbacks directly like a client receiving them
+	FPoolObjectsArray& GetPoolObjects(ABasePool* Pool)
+	{
+		const FStructProperty* PoolObjectsProperty = FindFProperty<FStructProperty>(ABasePool::StaticClass(), TEXT("PoolObjects"));
+		return *PoolObjectsProperty->ContainerPtrToValuePtr<FPoolObjectsArray>(Pool);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPoolClientPreWarmedActorDefaultsTest, "NetworkedPoolingSystem.ActorPool.ClientPreWarmedActorUsesClassDefaults",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPoolClientPreWarmedActorDefaultsTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = PoolSystemTests::CreateTestWorld();
+	AActorPoolBase* Pool = PoolSystemTests::SpawnClientPool<AActorPoolBase>(World);
+	FPoolObjectsArray& PoolObjects = PoolSystemTests::GetPoolObjects(Pool);
+
+	ADefaultPawn* PooledActor = World->SpawnActor<ADefaultPawn>();
+	UPrimitiveComponent* CollisionComponent = PooledActor->GetCollisionComponent();
+	const UPrimitiveComponent* Archetype = CastChecked<UPrimitiveComponent>(CollisionComponent->GetArchetype());
+
+	// the server prewarmed the actor, it reaches the client already free and the pool disables it before it is ever bound
+	PoolObjects.Add(PooledActor, true);
+	TArray<int32> ChangedIndices = { PoolObjects.Num() - 1 };
+	PoolObjects.PostReplicatedAdd(ChangedIndices, PoolObjects.Num());
+
+	TestFalse(TEXT("Free actor components are hidden"), CollisionComponent->GetVisibleFlag());
+	TestEqual(TEXT("Free actor components have no collision"), static_cast<int32>(CollisionComponent->GetCollisionEnabled()), static_cast<int32>(ECollisionEnabled::NoCollision));
+
+	// the server activates it, waking it up for replication
+	PoolObjects.Find(PooledActor).bIsFree = false;
+	PooledActor->SetNetDormancy(DORM_Awake);
+	PoolObjects.PostReplicatedChange(ChangedIndices, PoolObjects.Num());
+
+	TestEqual(TEXT("Visibility comes from the class"), CollisionComponent->GetVisibleFlag(), Archetype->GetVisibleFlag());
+	TestEqual(TEXT("Hidden in game comes from the class"), static_cast<bool>(CollisionComponent->bHiddenInGame), static_cast<bool>(Archetype->bHiddenInGame));
+	TestEqual(TEXT("Collision comes from the class"), static_cast<int32>(CollisionComponent->GetCollisionEnabled()), static_cast<int32>(Archetype->BodyInstance.GetCollisionEnabled(false)));
+
+	PoolSystemTests::DestroyTestWorld(World);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPoolReturnBeforeActivationTest, "NetworkedPoolingSystem.Subsystem.ReturnBeforeActivation",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPoolReturnBeforeActivationTest::RunTest(const FString& Parameters)
+{
+	// any budget keeps non critical activations pending until the next tick
+	UPoolSystemSettings* PoolSystemSettings = GetMutableDefault<UPoolSystemSettings>();
+	const float PreviousActivationFrameBudgetMs = PoolSystemSettings->ActivationFrameBudgetMs;
+	PoolSystemSettings->ActivationFrameBudgetMs = 1.f;
+
+	UWorld* World = PoolSystemTests::CreateTestWorld();
+	UPoolSubsystem* PoolSubsystem = PoolSystemTests::InitializePoolSubsystem(World);
+
+	UPoolLifecycleTestObject* PooledObject = Cast<UPoolLifecycleTestObject>(PoolSubsystem->RequestPoolObjectWithPriority(UPoolLifecycleTestObject::StaticClass(), FTransform::Identity, nullptr, EPoolActivationPriority::Normal));
+	if (TestNotNull(TEXT("Requested object"), PooledObject) && TestTrue(TEXT("Activation is pending"), PoolSubsystem->IsActivationPending(PooledObject)))
+	{
+		UPoolSubsystem::ReturnToPool(PooledObject);
+
+		TestFalse(TEXT("Activation is no longer pending"), PoolSubsystem->IsActivationPending(PooledObject));
+		TestFalse(TEXT("Object is back in the pool"), UPoolSubsystem::IsPooledObjectActive(PooledObject));
+		TestEqual(TEXT("Activate events"), PooledObject->NumActivations, 0);
+		TestEqual(TEXT("Deactivate events"), PooledObject->NumDeactivations, 0);
+
+		// a later tick must not activate it either
+		PoolSubsystem->Tick(0.f);
+		TestEqual(TEXT("Activate events after tick"), PooledObject->NumActivations, 0);
+	}
+
+	PoolSystemTests::DestroyTestWorld(World);
+	PoolSystemSettings->ActivationFrameBudgetMs = PreviousActivationFrameBudgetMs;
+	return true;
+}
+
+#endif
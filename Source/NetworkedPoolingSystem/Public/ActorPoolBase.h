@@ -4,36 +4,66 @@
 
 #include "CoreMinimal.h"
 #include "BasePool.h"
+#include "PooledMovementAdapters.h"
 #include "ActorPoolBase.generated.h"
 
 class UPoolSubsystem;
+class UPrimitiveComponent;
 
 USTRUCT()
 struct FDefaultComponentValues
 {
 	GENERATED_USTRUCT_BODY()
 
-	TSoftObjectPtr<UActorComponent> Component;
+	FName ComponentName;
+	UClass* ComponentClass = nullptr;
 	bool bAutoActivate = false;
 	FTransform RelativeTransform;
 	bool bVisible = false;
 	bool bHiddenInGame = false;
 	bool bSimulatesPhysics = false;
 	bool bGravityEnabled = false;
+	bool bIsPrimitive = false;
 	ECollisionEnabled::Type CollisionEnabled;
+	FCollisionResponseContainer CollisionResponses;
 };
 
+// Component defaults captured once per actor class and shared by every pooled instance, indexed by component
 USTRUCT()
 struct FDefaultComponentsValuesContainer
 {
 	GENERATED_USTRUCT_BODY()
 
-
-	const FDefaultComponentValues& FindComponent(UActorComponent* InComponent);
+	int32 FindComponentIndex(FName ComponentName) const;
 
 	void Add(const FDefaultComponentValues& InComponentValues);
 
 	TArray<FDefaultComponentValues> ComponentValues;
+	TMap<FName, int32> ComponentIndexByName;
+
+	/* Activation/deactivation plan, component indices grouped by the work they need so activating or returning
+	 * an actor is a flat loop over the components that actually need it, without casting */
+	TArray<int32> ParticleSystemIndices;
+	TArray<int32> SceneIndices;
+	TArray<int32> AutoActivateIndices;
+	TArray<int32> AudioIndices;
+	TArray<int32> PrimitiveIndices;
+	TArray<int32> HideIndices;
+	TArray<int32> DeactivateIndices;
+
+	// Movement components and the adapter resolved for their class
+	struct FMovementAdapterBinding
+	{
+		int32 ComponentIndex = INDEX_NONE;
+		TSharedPtr<IPooledMovementAdapter> Adapter;
+	};
+	TArray<FMovementAdapterBinding> MovementAdapters;
+};
+
+// Components of a pooled actor, in the same order as the ComponentValues of its class defaults
+struct FPooledActorComponents
+{
+	TArray<TWeakObjectPtr<UActorComponent>> Components;
 };
 
 /**
@@ -48,19 +78,59 @@ public:
 
 	virtual void BeginPlay() override;
 	virtual UObject* PreSpawnPoolObject(TSubclassOf<UObject> InClass, AActor* InOwner) override;
+	virtual UObject* PreWarmPoolObject(TSubclassOf<UObject> InClass) override;
 	virtual void FinishSpawningPoolObject(UObject* InTarget, const FTransform& InTransform) override;
 	virtual void ReturnToPool(UObject* InObject) override;
+	virtual void DestroyPoolObject(UObject* InObject) override;
+
+protected:
+	/* Free actors keep their physics bodies: they are made to ignore every channel, moved to ParkingLocation and put to sleep
+	 * instead of toggling simulation and collision, so returning and reusing them does not recreate physics state */
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Physics")
+	bool bUsePhysicsParking = false;
+
+	// Far away from the playable area, parked bodies ignore everything but they still live in the physics scene
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Physics", meta = (EditCondition = "bUsePhysicsParking"))
+	FVector ParkingLocation = FVector(0.f, 0.f, 500000.f);
+
+	/* Free actors idle for this long turn warm: their components are unregistered, releasing render and physics state,
+	 * and registered again when the actor is reused. 0 keeps free actors hot */
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Tiers", meta = (ClampMin = "0", Units = "s"))
+	float WarmAfterIdleTime = 0.f;
+
+	/* Free actors idle for this long turn cold: they are destroyed and spawned again from their class when needed.
+	 * Only done where the pool has authority, and never below FreeLowWatermark or the adaptive prewarm count. 0 never destroys free actors */
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Tiers", meta = (ClampMin = "0", Units = "s"))
+	float ColdAfterIdleTime = 0.f;
+
+	// How often free actors are checked for demotion
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Tiers", meta = (ClampMin = "0.1", Units = "s"))
+	float TierUpdateInterval = 1.f;
 	
 private:
 	virtual void Tick(float DeltaSeconds) override;
 	virtual void RegisterWithPoolSubsystem(UPoolSubsystem* Subsystem);
 	void TryRegisterWithPoolSubsystem();
 	void TryStoreComponentsDefaultValues(AActor* InTarget);
+
+	// Drops the component bindings of actors destroyed outside of DestroyPoolObject, e.g on clients losing a trimmed actor
+	UFUNCTION()
+	void OnPooledActorDestroyed(AActor* DestroyedActor);
+	const FDefaultComponentsValuesContainer* FindComponentsDefaultValues(AActor* InTarget, const FPooledActorComponents*& OutActorComponents) const;
 	void ActiveActorComponents(AActor* InTarget);
 	void ActivateMovementComponent(AActor* InTarget);
+	void ResetMovementComponents(AActor* InTarget);
 	void ResetComponentsTransform(AActor* InTarget);
 	void DeactivateComponents(AActor* InTarget);
+	void DeactivateUnboundComponents(AActor* InTarget);
 	void DisableActor(AActor* InTarget);
+	bool ShouldParkActor(AActor* InTarget) const;
+	void ParkPrimitiveComponent(UPrimitiveComponent* PrimitiveComp);
+	void UnparkPrimitiveComponent(UPrimitiveComponent* PrimitiveComp, const FDefaultComponentValues& ComponentDefaultValues);
+	void PutParkedBodiesToSleep(AActor* InTarget);
+	void UpdateFreeActorTiers();
+	void DemoteToWarm(AActor* InTarget);
+	void PromoteToHot(AActor* InTarget);
 	void SetActorEnabled(AActor* InTarget, bool bEnabled);
 	bool HasReplicatedProperties(AActor* TargetActor);
 	bool IsActorReadyToSpawn(AActor* TargetActor);
@@ -74,5 +144,7 @@ private:
 		FTransform Transform;
 	};
 	TArray<FPendingActorData> WaitingToSpawnActorQueue;
-	TMap<AActor*, FDefaultComponentsValuesContainer> ActorDefaultComponentValuesMap; 
+	TMap<TObjectKey<UClass>, FDefaultComponentsValuesContainer> ClassDefaultComponentValuesMap;
+	TMap<TObjectKey<AActor>, FPooledActorComponents> PooledActorComponentsMap;
+	FTimerHandle TierUpdateTimerHandle;
 };
@@ -9,6 +9,94 @@
 #include "UObject/NoExportTypes.h"
 #include "BasePool.generated.h"
 
+// What a pool does with a request for a class that has no free object left and reached its maximum size
+UENUM(BlueprintType)
+enum class EPoolOverflowPolicy : uint8
+{
+	// Spawn a new object anyway
+	Grow,
+	// Refuse the request
+	FailFast,
+	// Return the oldest active object of the class and hand it out again, e.g for decals, impact effects or shell casings
+	RecycleOldest,
+	// Refuse synchronous requests, queued requests wait until an object of the class is free
+	Queue
+};
+
+// What a pool does with a request from an owner that already has its maximum number of active objects
+UENUM(BlueprintType)
+enum class EPoolOwnerQuotaPolicy : uint8
+{
+	// Refuse the request
+	Reject,
+	// Return the oldest active object of that owner to make room for the new one
+	RecycleOwnOldest
+};
+
+// Counters to size pools, a request over the limit is counted once as overflow and once as what the policy did with it
+USTRUCT(BlueprintType)
+struct FPoolOverflowStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pooling")
+	int32 OverflowCount = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pooling")
+	int32 GrownCount = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pooling")
+	int32 FailedCount = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pooling")
+	int32 RecycledCount = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pooling")
+	int32 QueuedCount = 0;
+
+	// Requests refused because their owner reached its quota
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pooling")
+	int32 QuotaRejectedCount = 0;
+
+	// Objects returned to make room for another object of the same owner
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pooling")
+	int32 QuotaRecycledCount = 0;
+
+	// Largest number of objects the pool ever had
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pooling")
+	int32 PeakSize = 0;
+};
+
+// Demand of one class over the lifetime of a pool, recorded into the demand profile of the map
+struct FPoolClassUsage
+{
+	// Most objects of the class active at the same time
+	int32 HighWaterMark = 0;
+
+	// Requests that found no free object of the class
+	int32 MissCount = 0;
+};
+
+// Properties reset on a class, built the first time an object of that class returns to the pool with a given exclude list and reused afterwards
+struct FPropertyResetPlan
+{
+	// Sorted exclude list the plan was built for, objects of the same class can exclude different properties
+	TArray<FName> ExcludedProperties;
+
+
+	struct FMemoryRange
+	{
+		int32 Offset = 0;
+		int32 Size = 0;
+	};
+
+	// Adjacent plain old data properties coalesced into ranges copied straight from the default object
+	TArray<FMemoryRange> MemoryRanges;
+
+	// Properties that have to be copied through the property system, e.g arrays and bitfields
+	TArray<FProperty*> Properties;
+};
+
 /**
  * 
  */
@@ -22,14 +110,55 @@ public:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 
 	virtual UObject* PreSpawnPoolObject(TSubclassOf<UObject> InClass, AActor* InOwner);
+
+	// PreSpawnPoolObject going through the size limits first, nullptr if the overflow policy refused the request
+	UObject* AcquirePoolObject(TSubclassOf<UObject> InClass, AActor* InOwner);
+	void NotifyRequestQueued();
+
+	// True when no new object of this class can be created without going over the pool or class maximum size
+	bool IsAtCapacity(TSubclassOf<UObject> InClass);
+	bool HasFreeObject(TSubclassOf<UObject> InClass) { return PoolObjects.HasFreeObject(InClass); }
+	EPoolOverflowPolicy GetOverflowPolicy() const { return OverflowPolicy; }
+
+	UFUNCTION(BlueprintPure, Category = "Object Pooling")
+	const FPoolOverflowStats& GetOverflowStats() const { return OverflowStats; }
+
+	const TMap<TObjectKey<UClass>, FPoolClassUsage>& GetClassUsage() const { return UsageByClass; }
+
+	/*Acquisitions per second of this class, smoothed over DemandHalfLife. Only tracked with bAdaptivePreWarm*/
+	UFUNCTION(BlueprintPure, Category = "Object Pooling")
+	float GetDemandRate(TSubclassOf<UObject> InClass) const;
+
+	// Active objects acquired with this owner
+	int32 GetNumActiveObjectsOwnedBy(const AActor* InOwner) const;
+	void GetActiveObjectsOwnedBy(const AActor* InOwner, TArray<UObject*>& OutObjects) const;
+	void GetActiveObjectsOfClass(TSubclassOf<UObject> InClass, TArray<UObject*>& OutObjects);
+	void GetActiveObjectSegments(const UClass* InClass, FPoolActiveObjectsSegments& OutSegments) { PoolObjects.GetActiveSegments(InClass, OutSegments); }
+
+	// ForceNetUpdate for changes to the pool state, coalesced by the subsystem into one per frame
+	void RequestNetUpdate();
+
+	// Creates a new object straight into the free state, pools override it to skip the activate/return round trip
+	virtual UObject* PreWarmPoolObject(TSubclassOf<UObject> InClass);
 	void PreAllocateObjects(TArray<TSoftClassPtr<UObject>> PreAllocastionClasses, int32 PreAllocationNumber);
 	
 	virtual void FinishSpawningPoolObject(UObject* Target, const FTransform& Transform);
 	void ResetToDefaultValues(UObject* Object);
 	virtual void ReturnToPool(UObject* Object);
 
+	// Drops a free object from the pool for good, the class data it used (e.g reset plans) is kept to spawn it again
+	virtual void DestroyPoolObject(UObject* Object);
+
+	/* Destroys excess free objects and compacts the pool, authority only. Under memory pressure every free object above
+	 * FreeLowWatermark goes, otherwise only the ones above FreeHighWatermark or idle for longer than TrimIdleTime.
+	 * The watermarks are counted for each class on its own */
+	void TrimFreeObjects(bool bUnderMemoryPressure = false);
+
 	const TSubclassOf<UObject>& GetTargetclass() const { return TargetClass; }
 	bool ShouldIncludeChildrenClasses() const { return bIncludeChildrenClasses; }
 
@@ -44,6 +173,18 @@ protected:
 	void BP_OnPreSpawnPoolObject(UObject* Object, AActor* InOwner = nullptr);
 	
 	bool IsClassFromProject(UClass* Class);
+	static bool IsPackageFromProject(const FString& PackageName);
+
+	/* Free objects of the class that trimming and the idle tiers never destroy: FreeLowWatermark, or the count adaptive
+	 * prewarming grew the class to when higher. Under memory pressure only the low watermark is kept */
+	int32 GetKeptFreeCount(const UClass* InClass, bool bUnderMemoryPressure = false) const;
+
+	// Objects created by PreSpawnPoolObject that only join the pool once they finish spawning, e.g deferred actors
+	void AddPendingSpawn(UObject* Object);
+	void RemovePendingSpawn(UObject* Object);
+
+	// Pending spawns of the exact class, or of every class when null. Spawns destroyed before finishing are dropped
+	int32 NumPendingSpawns(const UClass* InClass = nullptr);
 	
 	template<typename T>
 	T* FindInPool(TSubclassOf<UObject> Class)
@@ -68,12 +209,114 @@ protected:
 	}
 
 private:
+#if WITH_EDITOR
+	void OnObjectsReinstanced(const TMap<UObject*, UObject*>& OldToNewInstanceMap);
+#endif
 	bool CanResetProperty(FProperty* Property) const;
+	bool CanCopyPropertyMemory(FProperty* Property) const;
+	const FPropertyResetPlan& GetPropertyResetPlan(UObject* Object);
+	bool MakeRoomForOwner(AActor* InOwner);
+	void TrackOwnedObject(UObject* Object, AActor* InOwner);
+	void UntrackOwnedObject(UObject* Object);
+	// FreeLowWatermark can not go over an enabled FreeHighWatermark, returns false if it had to be clamped
+	bool ClampFreeWatermarks();
+	void UpdateAdaptivePreWarm();
 	
 protected:
+	// Maximum number of objects in the pool, free or not. 0 is unlimited
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Capacity", meta = (ClampMin = "0"))
+	int32 MaxPoolSize = 0;
+
+	// Maximum number of objects of a class, checked on the exact class of the requested object
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Capacity")
+	TMap<TSubclassOf<UObject>, int32> MaxObjectsPerClass;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Capacity")
+	EPoolOverflowPolicy OverflowPolicy = EPoolOverflowPolicy::Grow;
+
+	// Maximum number of active objects acquired with the same owner, so one player cannot drain a shared pool. 0 is unlimited
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Capacity", meta = (ClampMin = "0"))
+	int32 MaxActiveObjectsPerOwner = 0;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Capacity")
+	EPoolOwnerQuotaPolicy OwnerQuotaPolicy = EPoolOwnerQuotaPolicy::Reject;
+
+	// Free objects of each class kept when trimming, the pool never trims a class below this
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Trimming", meta = (ClampMin = "0"))
+	int32 FreeLowWatermark = 0;
+
+	// Free objects of a class above this count are destroyed on the next trim. 0 disables it
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Trimming", meta = (ClampMin = "0"))
+	int32 FreeHighWatermark = 0;
+
+	// Free objects idle for longer than this are destroyed, down to FreeLowWatermark. 0 disables it
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Trimming", meta = (ClampMin = "0", Units = "s"))
+	float TrimIdleTime = 0.f;
+
+	// How often the watermarks and idle time are checked
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Trimming", meta = (ClampMin = "0.1", Units = "s"))
+	float TrimInterval = 5.f;
+
+	/* Tracks how fast each class is requested and prewarms ahead of it, so the pool keeps enough free objects
+	 * for the demand expected over AdaptiveLeadTime. Trimming keeps those objects unless the engine is low on memory */
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Adaptive PreWarm")
+	bool bAdaptivePreWarm = false;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Adaptive PreWarm", meta = (EditCondition = "bAdaptivePreWarm", ClampMin = "0.0", Units = "s"))
+	float AdaptiveLeadTime = 1.f;
+
+	// Time it takes for a burst of requests to weigh half as much in the demand rate
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Adaptive PreWarm", meta = (EditCondition = "bAdaptivePreWarm", ClampMin = "0.1", Units = "s"))
+	float DemandHalfLife = 2.f;
+
+	// Free objects kept per class no matter the demand
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Adaptive PreWarm", meta = (EditCondition = "bAdaptivePreWarm", ClampMin = "0"))
+	int32 AdaptiveMinFreeObjects = 0;
+
+	// Free objects per class the demand can ask for at most
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Adaptive PreWarm", meta = (EditCondition = "bAdaptivePreWarm", ClampMin = "0"))
+	int32 AdaptiveMaxFreeObjects = 32;
+
+	// Objects of a class queued for creation per update at most, the pool size limits still apply
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Adaptive PreWarm", meta = (EditCondition = "bAdaptivePreWarm", ClampMin = "1"))
+	int32 AdaptiveMaxGrowthPerUpdate = 8;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Pool|Adaptive PreWarm", meta = (EditCondition = "bAdaptivePreWarm", ClampMin = "0.05", Units = "s"))
+	float AdaptiveUpdateInterval = 0.25f;
+
 	TSubclassOf<UObject> TargetClass;
 	bool bIncludeChildrenClasses = true;
 	
 	UPROPERTY(Replicated)
 	FPoolObjectsArray PoolObjects;
+
+	FPoolOverflowStats OverflowStats;
+
+private:
+	// Most classes only ever use one exclude list, so one plan per class
+	TMap<TObjectKey<UClass>, TArray<FPropertyResetPlan, TInlineAllocator<1>>> PropertyResetPlans;
+	// Answer of IsClassFromProject per class, cleared when classes are reinstanced
+	TMap<TObjectKey<UClass>, bool> ProjectClassCache;
+#if WITH_EDITOR
+	FDelegateHandle ObjectsReinstancedHandle;
+#endif
+	TMap<TObjectKey<UClass>, TArray<TWeakObjectPtr<UObject>>> PendingSpawnsByClass;
+
+	// Active objects per owner they were acquired with, oldest first, and the way back from an object to its owner
+	TMap<TObjectKey<AActor>, TArray<TWeakObjectPtr<UObject>>> ActiveObjectsByOwner;
+	TMap<TObjectKey<UObject>, TObjectKey<AActor>> ActiveObjectOwners;
+
+	FTimerHandle TrimTimerHandle;
+
+	struct FPoolClassDemand
+	{
+		// Requests since the last update
+		int32 Acquisitions = 0;
+		float Rate = 0.f;
+		int32 TargetFreeCount = 0;
+	};
+	TMap<TObjectKey<UClass>, FPoolClassDemand> DemandByClass;
+	TMap<TObjectKey<UClass>, FPoolClassUsage> UsageByClass;
+	double LastDemandUpdateTime = 0.0;
+	FTimerHandle AdaptivePreWarmTimerHandle;
 };
@@ -18,4 +18,5 @@ public:
 	AObjectPoolBase(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 	virtual UObject* PreSpawnPoolObject(TSubclassOf<UObject> InClass, AActor* InOwner = nullptr) override;
+	virtual UObject* PreWarmPoolObject(TSubclassOf<UObject> InClass) override;
 };
@@ -6,6 +6,17 @@
 #include "UObject/Interface.h"
 #include "PoolInterface.generated.h"
 
+// Which IPoolInterface hooks a class implements and how they have to be called, cached per class by UPoolSubsystem
+struct FPoolInterfaceClassInfo
+{
+	bool bImplementsInterface = false;
+
+	// Hooks that can be called directly on the native interface, otherwise they go through ProcessEvent (Blueprint implementations)
+	bool bNativeConstruct = false;
+	bool bNativeActivate = false;
+	bool bNativeDeactivate = false;
+};
+
 // This class does not need to be modified.
 UINTERFACE(MinimalAPI)
 class UPoolInterface : public UInterface
@@ -37,6 +48,7 @@ public:
 	void OnPoolObjectDeactivate();
 	virtual void OnPoolObjectDeactivate_Implementation() = 0;
 
+	// Properties the automatic reset skips, asked to the object every time it returns to the pool.
 	UFUNCTION(BlueprintNativeEvent, Category="Object Pooling")
 	TArray<FString> GetPropertyResetExcludeList();
 	virtual TArray<FString> GetPropertyResetExcludeList_Implementation() = 0;
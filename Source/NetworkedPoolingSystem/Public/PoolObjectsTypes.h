@@ -13,6 +13,19 @@ class ABasePool;
 
 
 DECLARE_LOG_CATEGORY_EXTERN(LogPoolSubsystem, Log, All);
+
+// How ready a free object is to be reused, objects demote while they stay idle in the pool
+UENUM()
+enum class EPoolObjectTier : uint8
+{
+	// Fully set up, reused instantly
+	Hot,
+	// Kept alive but stripped of its scene and physics state, restored when it is reused
+	Warm,
+	// Destroyed, only its class information is kept to spawn it again
+	Cold
+};
+
 // FPoolObjectItem:
 /* this array struct is used to pool objects manipulation, it helps with replication of pool object data, in this case
  * we use it for transform replication for objects that do not replicate movement and for setting free/used state on the client
@@ -40,6 +53,28 @@ struct FPoolObjectItem : public FFastArraySerializerItem
 
 	UPROPERTY(NotReplicated)
 	bool bIsFirstSpawn = true;
+
+	// Position of this item inside the free list of its class, INDEX_NONE if it is not listed
+	UPROPERTY(NotReplicated)
+	int32 FreeListSlot = INDEX_NONE;
+
+	// Position of this item inside the active list of its class, INDEX_NONE if it is not listed
+	UPROPERTY(NotReplicated)
+	int32 ActiveListSlot = INDEX_NONE;
+
+	// Local time this item was last returned, used to demote idle objects
+	UPROPERTY(NotReplicated)
+	double FreeSinceTime = 0.0;
+
+	UPROPERTY(NotReplicated)
+	EPoolObjectTier Tier = EPoolObjectTier::Hot;
+
+	// Increases every time the object is taken from the pool, tells stale entries of the activation queues apart
+	UPROPERTY(NotReplicated)
+	uint32 ActivationSerial = 0;
+
+	// Key of the free or active list this item was last put in, kept after the object is garbage collected so it can still be unlisted
+	const UClass* ListedClass = nullptr;
 	
 	void SetTransform(const FTransform& InTransform)
 	{
@@ -54,6 +89,17 @@ struct FPoolObjectItem : public FFastArraySerializerItem
 	}
 };
 
+struct FPoolObjectsArray;
+
+// Active object indices of one class inside one pool
+struct FPoolActiveObjectsSegment
+{
+	const FPoolObjectsArray* Objects = nullptr;
+	const UClass* Class = nullptr;
+	TConstArrayView<int32> Indices;
+};
+using FPoolActiveObjectsSegments = TArray<FPoolActiveObjectsSegment, TInlineAllocator<8>>;
+
 USTRUCT(BlueprintType)
 struct FPoolObjectsArray : public FFastArraySerializer
 {
@@ -70,13 +116,18 @@ struct FPoolObjectsArray : public FFastArraySerializer
 	
 	FPoolObjectItem& Add(UObject* Target, bool bIsFree);
 
+	// Removes the target from the pool, the last item takes its slot. Authority only, clients receive the removal
+	bool Remove(UObject* Target);
+
 	// Contains function to check if the target object exists in the pool
 	bool Contains(UObject* Target) const
 	{
-		return PoolObjects.ContainsByPredicate([Target](const FPoolObjectItem& Item)
-		{
-			return Item.Object == Target;
-		});
+		return FindIndex(Target) != INDEX_NONE;
+	}
+
+	int32 Num() const
+	{
+		return PoolObjects.Num();
 	}
 	
 	//~FFastArraySerializer contract
@@ -92,8 +143,54 @@ struct FPoolObjectsArray : public FFastArraySerializer
 	void SetItemTransform(AActor* Target, const FTransform& InTransform);
 	bool IsFirstSpawn(AActor* Target);
 
-	// Get the first free object from the pool
+	// Get the most recently returned free object of this class from the pool
 	UObject* GetFreeObject(TSubclassOf<UObject> Class);
+
+	// Whether GetFreeObject would return an object of this class
+	bool HasFreeObject(TSubclassOf<UObject> Class);
+
+	// Objects of exactly this class in the pool, free or not
+	int32 NumOfClass(const UClass* Class);
+
+	// Free objects of exactly this class, objects destroyed while free are counted until GetFreeObject skips them
+	int32 NumFreeOfClass(const UClass* Class);
+
+	// Active objects of this class or its children
+	void GetActiveObjectsOfClass(const UClass* Class, TArray<UObject*>& OutObjects);
+
+	// Appends the dense active lists of this class and its children, valid until an object is taken or returned
+	void GetActiveSegments(const UClass* Class, FPoolActiveObjectsSegments& OutSegments);
+
+	// Object at Index if it is still the active one listed at Slot of the ListClass active list, nullptr otherwise
+	UObject* GetActiveObjectAt(const UClass* ListClass, int32 Index, int32 Slot) const
+	{
+		if (!PoolObjects.IsValidIndex(Index))
+		{
+			return nullptr;
+		}
+
+		const FPoolObjectItem& Item = PoolObjects[Index];
+		return !Item.bIsFree && Item.ActiveListSlot == Slot && Item.ListedClass == ListClass ? Item.Object : nullptr;
+	}
+
+	/* Active object of this class taken from the pool the longest time ago, nullptr if none is active. Only peeks, the
+	 * entry is skipped on later calls once the object is actually free */
+	UObject* GetOldestActiveObject(TSubclassOf<UObject> Class);
+
+	// Free objects in the given tier that have been idle since before IdleSinceTime
+	void GetIdleFreeObjects(EPoolObjectTier Tier, double IdleSinceTime, TArray<UObject*>& OutObjects) const;
+
+	// Exact classes with free objects in the pool
+	void GetFreeClasses(TArray<const UClass*>& OutClasses);
+
+	// Free objects of the exact class returned before IdleSinceTime, the ones idle for longer first
+	void GetFreeObjectsOldestFirst(const UClass* Class, TArray<UObject*>& OutObjects, double IdleSinceTime = TNumericLimits<double>::Max());
+
+	// Releases the slack left by removed objects, replication ids are untouched so clients are not affected
+	void Shrink();
+
+	EPoolObjectTier GetObjectTier(UObject* Target) const;
+	void SetObjectTier(UObject* Target, EPoolObjectTier Tier);
 	
 	// Serialization function
 	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
@@ -106,12 +203,123 @@ struct FPoolObjectsArray : public FFastArraySerializer
 private:
 	void CheckItemPostReplication(FPoolObjectItem& Item);
 
+	// Indexes and lists one item added or changed by replication, removals still rebuild everything
+	void UpdateReplicatedItem(int32 Index);
+
+	// Returns the index of the target inside PoolObjects or INDEX_NONE, constant time through ObjectIndexMap
+	int32 FindIndex(const UObject* Target) const;
+	void RebuildObjectIndex() const;
+
+	// Keeps the item inside (or outside) the free list of its class depending on its bIsFree state
+	void UpdateFreeList(int32 Index);
+	void RemoveFromFreeList(int32 Index);
+	void UpdateActiveList(int32 Index);
+	void RemoveFromActiveList(int32 Index);
+	void RebuildFreeLists();
+	void RecordActivation(int32 Index);
+
 private:
 	UPROPERTY()
 	TArray<FPoolObjectItem> PoolObjects;
 	
 	UPROPERTY(NotReplicated)
 	TObjectPtr<ABasePool> OwningPool;
+
+	/* Local lookup from object to its slot in PoolObjects, never replicated.
+	 * Replication can add, remove (swapping) and resolve objects on clients, so it is rebuilt lazily after those */
+	mutable TMap<const UObject*, int32> ObjectIndexMap;
+	mutable bool bObjectIndexDirty = false;
+
+	/* Free item indices per exact class, used as LIFO stacks so the most recently returned (and cache warm) object is reused first.
+	 * Local only, rebuilt after replication the same way as ObjectIndexMap */
+	TMap<const UClass*, TArray<int32>> FreeIndicesByClass;
+	bool bFreeListsDirty = false;
+
+	// Active item indices per exact class, kept dense so active objects can be visited without walking the free ones
+	TMap<const UClass*, TArray<int32>> ActiveIndicesByClass;
+
+	// Object count per exact class, rebuilt along with the free lists
+	TMap<const UClass*, int32> NumObjectsByClass;
+
+	/* Objects per class in the order they were taken from the pool, oldest at Head. Entries are not removed when
+	 * the object returns, they are skipped when their serial no longer matches the item */
+	struct FActivationQueue
+	{
+		TArray<TPair<const UObject*, uint32>> Entries;
+		int32 Head = 0;
+	};
+	TMap<const UClass*, FActivationQueue> ActivationQueues;
+	uint32 NextActivationSerial = 1;
+};
+
+/* Range over active pool objects, gathered per pool and class as views over their dense active lists so
+ * `for (AActor* Actor : Range)` only visits live objects. Taking or returning pool objects while iterating invalidates it */
+template<typename T>
+class TPoolActiveObjectsRange
+{
+public:
+	explicit TPoolActiveObjectsRange(FPoolActiveObjectsSegments&& InSegments)
+		: Segments(MoveTemp(InSegments))
+	{
+	}
+
+	class FIterator
+	{
+	public:
+		FIterator(const FPoolActiveObjectsSegments& InSegments, int32 InSegmentIndex)
+			: Segments(InSegments)
+			, SegmentIndex(InSegmentIndex)
+		{
+			SkipStaleEntries();
+		}
+
+		T* operator*() const
+		{
+			return static_cast<T*>(Current);
+		}
+
+		FIterator& operator++()
+		{
+			++Slot;
+			SkipStaleEntries();
+			return *this;
+		}
+
+		bool operator!=(const FIterator& Other) const
+		{
+			return SegmentIndex != Other.SegmentIndex || Slot != Other.Slot;
+		}
+
+	private:
+		void SkipStaleEntries()
+		{
+			for (; SegmentIndex < Segments.Num(); ++SegmentIndex, Slot = 0)
+			{
+				const FPoolActiveObjectsSegment& Segment = Segments[SegmentIndex];
+				for (; Slot < Segment.Indices.Num(); ++Slot)
+				{
+					Current = Segment.Objects->GetActiveObjectAt(Segment.Class, Segment.Indices[Slot], Slot);
+					if (Current)
+					{
+						return;
+					}
+				}
+			}
+
+			Current = nullptr;
+		}
+
+		const FPoolActiveObjectsSegments& Segments;
+		int32 SegmentIndex = 0;
+		int32 Slot = 0;
+		UObject* Current = nullptr;
+	};
+
+	FIterator begin() const { return FIterator(Segments, 0); }
+	FIterator end() const { return FIterator(Segments, Segments.Num()); }
+
+private:
+	FPoolActiveObjectsSegments Segments;
 };
 
 template<>
@@ -8,31 +8,138 @@
 #include "Subsystems/WorldSubsystem.h"
 #include "Engine/World.h"
 #include "Engine/EngineTypes.h"
+#include "PoolSystemSettings.h"
+#include <atomic>
 #include "PoolSubsystem.generated.h"
 
+struct FStreamableHandle;
+
 class ABasePool;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnPoolsPreWarmed);
+
+// Net updates requested by the pools against the ones actually sent once coalesced per frame
+USTRUCT(BlueprintType)
+struct FPoolNetUpdateStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Object Pooling")
+	int32 PoolNetUpdatesRequested = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Object Pooling")
+	int32 PoolNetUpdatesSent = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Object Pooling")
+	int32 ActorNetUpdatesRequested = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Object Pooling")
+	int32 ActorNetUpdatesSent = 0;
+
+	// Dormancy changes actually applied, actors returned and reused within the same frame do not change it
+	UPROPERTY(BlueprintReadOnly, Category="Object Pooling")
+	int32 DormancyChanges = 0;
+};
+
+USTRUCT()
+struct FPoolClassDemandProfile
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FSoftClassPath Class;
+
+	/* Most objects of the class active at once, weighted towards the latest sessions with DemandProfileSessionWeight.
+	 * Sessions where requests found no free object raise it straight to their peak */
+	UPROPERTY()
+	float HighWaterMark = 0.f;
+
+	// Requests that found no free object during the last session
+	UPROPERTY()
+	int32 MissCount = 0;
+};
+
+// Pool demand of one map, saved as json between sessions when bUseDemandProfiles is set
+USTRUCT()
+struct FPoolDemandProfile
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FPoolClassDemandProfile> Classes;
+};
+
+// How urgently an object requested through RequestPoolObjectWithPriority has to be activated
+UENUM(BlueprintType)
+enum class EPoolActivationPriority : uint8
+{
+	// Gameplay relevant, always activated in the same call
+	Critical,
+	High,
+	Normal,
+	// Cosmetics like debris or shells, the first ones to wait when the frame budget runs out
+	Low
+};
+
 /**
  * 
  */
 UCLASS()
-class NETWORKEDPOOLINGSYSTEM_API UPoolSubsystem : public UWorldSubsystem
+class NETWORKEDPOOLINGSYSTEM_API UPoolSubsystem : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
 	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// Keeps the classes of queued prewarms and requests loaded, their streamable handles are gone once the loads finish
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
 	
 	template<class T>
 	T* RequestPoolObject(TSubclassOf<UObject> Class, AActor* Owner, bool bDeferred = false);
 
+	/* Requests and activates Count objects of the same class in one pass, e.g for shotgun blasts or cluster bombs.
+	 * Transforms holds one transform per object, missing ones default to identity. The pool is resolved once and sends a
+	 * single net update for the whole batch. Stops early if the pool refuses a request, returns how many were added to OutObjects */
+	int32 RequestPoolObjects(TSubclassOf<UObject> Class, int32 Count, TConstArrayView<FTransform> Transforms, AActor* Owner, TArray<UObject*>& OutObjects);
+
+	/*Requests and activates one object per transform in one pass, see RequestPoolObjects*/
+	UFUNCTION(BlueprintCallable, Category="Object Pooling", meta=(DisplayName="Request Pool Objects", DeterminesOutputType="Class"))
+	TArray<UObject*> K2_RequestPoolObjects(TSubclassOf<UObject> Class, const TArray<FTransform>& Transforms, AActor* Owner = nullptr);
+
+	/* RequestPoolObject for pools using the Queue overflow policy: when the pool is full the request waits until an object
+	 * of the class is free. OnAcquired is called once, right away or from a later tick, with nullptr if the request failed */
+	void RequestPoolObjectQueued(TSubclassOf<UObject> Class, AActor* Owner, TFunction<void(UObject*)> OnAcquired, bool bDeferred = false);
+
 	template<class T>
 	T* FinishSpawningPoolObject(UObject* Target, const FTransform& Transform = FTransform::Identity);
 
+	/* Requests an object and activates it at Transform. Critical requests are activated right away, the rest wait in a queue
+	 * drained highest priority first within ActivationFrameBudgetMs. The object is taken from the pool immediately,
+	 * returning it before its activation drops the pending entry */
+	UFUNCTION(BlueprintCallable, Category="Object Pooling", meta=(DeterminesOutputType="Class"))
+	UObject* RequestPoolObjectWithPriority(TSubclassOf<UObject> Class, const FTransform& Transform, AActor* Owner = nullptr, EPoolActivationPriority Priority = EPoolActivationPriority::Normal);
+
+	/*Whether this object was requested with a priority and is still waiting to be activated*/
+	UFUNCTION(BlueprintPure, Category="Object Pooling")
+	bool IsActivationPending(UObject* Object) const;
+
 	/*Checks wether or not this actor is currently being used, or waiting on the pool*/
 	UFUNCTION(BlueprintPure, Category="Object Pooling")
 	static bool IsPooledObjectActive(UObject* Object);
 	
 	UFUNCTION(BlueprintCallable, Category="Object Pooling")
 	static void ReturnToPool(UObject* TargetObject);
+
+	/*Returns every active object requested with this owner, e.g when a pawn dies or a player leaves. Returns how many were returned*/
+	UFUNCTION(BlueprintCallable, Category="Object Pooling")
+	int32 ReturnAllOwnedBy(AActor* Owner);
+
+	/*Returns every active object of this class or its children. Returns how many were returned*/
+	UFUNCTION(BlueprintCallable, Category="Object Pooling")
+	int32 ReturnAllOfClass(TSubclassOf<UObject> Class);
 	
 	// ===== Exclusive use for K2 spawn node ===== 
 	UFUNCTION(BlueprintCallable, Category = "Pool", meta=(WorldContext = "WorldContextObject", UnsafeDuringActorConstruction = "true", BlueprintInternalUseOnly = "true", DeterminesOutputType = "ActorClass"))
@@ -49,11 +156,107 @@ public:
 	// ==========================================
 
 	void RegisterPool(ABasePool* Pool);
+	void UnregisterPool(ABasePool* Pool);
+
+	// Forgets the pool an object belonged to, called when a pool destroys one of its objects
+	void UnregisterPoolObject(UObject* Object);
+
+	/* Active objects of this class and its children in every pool, for range based for loops:
+	 * for (AMyProjectile* Projectile : PoolSubsystem->GetActivePoolObjects<AMyProjectile>(AMyProjectile::StaticClass()))
+	 * Only live objects are visited and nothing is allocated unless the class is spread over many pools and child classes.
+	 * Do not request or return pool objects while iterating */
+	template<class T>
+	TPoolActiveObjectsRange<T> GetActivePoolObjects(TSubclassOf<T> Class);
+
+	/*Snapshot of the active objects of this class and its children, the Blueprint way to loop over them.
+	 * Unlike the range above it can be iterated while objects are requested or returned*/
+	UFUNCTION(BlueprintCallable, Category="Object Pooling", meta=(DeterminesOutputType="Class", DynamicOutputParam="OutObjects"))
+	void GetActivePoolObjects(TSubclassOf<UObject> Class, TArray<UObject*>& OutObjects);
+
+	/*Number of active objects of this class and its children*/
+	UFUNCTION(BlueprintPure, Category="Object Pooling")
+	int32 GetNumActivePoolObjects(TSubclassOf<UObject> Class);
+
+	/*Active object at Index, from 0 to GetNumActivePoolObjects - 1. Can be null for objects destroyed while active.
+	 * Every call walks all the pools again, to loop over the active objects use GetActivePoolObjects instead*/
+	UFUNCTION(BlueprintPure, Category="Object Pooling", meta=(DeterminesOutputType="Class"))
+	UObject* GetActivePoolObjectAt(TSubclassOf<UObject> Class, int32 Index);
+
+	// Coalesced into a single ForceNetUpdate per pool, sent at the end of the subsystem tick
+	void RequestPoolNetUpdate(ABasePool* Pool);
+
+	// Coalesced into a single dormancy change and ForceNetUpdate per actor, sent at the end of the subsystem tick
+	void RequestActorNetUpdate(AActor* Actor, ENetDormancy Dormancy);
+
+	/*Forced net updates requested by the pools and how many were actually sent*/
+	UFUNCTION(BlueprintPure, Category="Object Pooling")
+	const FPoolNetUpdateStats& GetNetUpdateStats() const { return NetUpdateStats; }
+
+	/*Overflow counters of the pool serving this class, use them to size your pools*/
+	UFUNCTION(BlueprintPure, Category="Object Pooling")
+	FPoolOverflowStats GetPoolOverflowStats(TSubclassOf<UObject> Class);
+
+	/*Destroys the free objects of every pool down to their low watermark, also done when the engine asks to trim memory*/
+	UFUNCTION(BlueprintCallable, Category="Object Pooling")
+	void TrimPools();
+
+	/* Queues objects to be created into the pool free state, spread over frames using PreWarmFrameBudgetMs.
+	 * Runtime growth passes bTrackProgress false so it does not show up in the begin play prewarm progress */
+	void QueuePreWarm(ABasePool* Pool, TSubclassOf<UObject> Class, int32 Count, int32 Priority = 0, bool bTrackProgress = true);
+
+	// Objects of this class still waiting in the prewarm queue for this pool
+	int32 GetQueuedPreWarmCount(const ABasePool* Pool, const UClass* Class) const;
+
+	/*Ratio of the queued objects already prewarmed, 1 once every pool finished prewarming*/
+	UFUNCTION(BlueprintPure, Category="Object Pooling")
+	float GetPreWarmProgress() const;
+
+	UFUNCTION(BlueprintPure, Category="Object Pooling")
+	bool IsPreWarmComplete() const;
+
+	// Broadcast once the pools spawned on begin play finished prewarming, check IsPreWarmComplete before binding
+	UPROPERTY(BlueprintAssignable, Category="Object Pooling")
+	FOnPoolsPreWarmed OnPreWarmCompleted;
+
+	// IPoolInterface lifecycle calls, native implementations are called directly instead of through ProcessEvent
+	void NotifyPoolObjectConstruct(UObject* Object);
+	void NotifyPoolObjectActivate(UObject* Object);
+	void NotifyPoolObjectDeactivate(UObject* Object);
 private:
+	const FPoolInterfaceClassInfo& GetInterfaceClassInfo(UClass* Class);
+	void NotifyPoolObjectConstruct(UObject* Object, const FPoolInterfaceClassInfo& ClassInfo);
+	void NotifyPoolObjectActivate(UObject* Object, const FPoolInterfaceClassInfo& ClassInfo);
+	void NotifyPoolObjectDeactivate(UObject* Object, const FPoolInterfaceClassInfo& ClassInfo);
+
 	ABasePool* FindClassInPool(TSubclassOf<UObject> Class, TArray<ABasePool*>& PoolToUse);
 	ABasePool* FindPool(UClass* Class);
 	ABasePool* FindPool(UObject* Target);
 	void InitializePools();
+	void OnPoolClassesLoaded(int32 LoadId);
+	void SpawnConfiguredPool(const FPoolsToSpawn& PoolToSpawn);
+	void FlushPendingPoolLoads();
+	bool IsDefaultPool(const ABasePool* Pool) const;
+	void TickPreWarm();
+	void CheckPreWarmCompleted();
+	void OnMemoryTrim();
+	// Drops the entries of objects destroyed without going through their pool, e.g by level streaming or a direct Destroy
+	void PruneObjectOwningPools();
+	void TickQueuedRequests();
+	void TickPendingActivations();
+	// Drops the pending activation of the object, returns false if it had none
+	bool CancelPendingActivation(UObject* Object, FTransform* OutTransform = nullptr);
+	// Called before an object goes back to its pool, returns true if its activation was still pending
+	bool DropPendingActivation(ABasePool* Pool, UObject* Object);
+	int32 ReturnObjectsToPool(ABasePool* Pool, TConstArrayView<UObject*> Objects);
+	void GetActiveObjectSegments(const UClass* Class, FPoolActiveObjectsSegments& OutSegments);
+	void FlushNetUpdates();
+	void LoadDemandProfile();
+	void SaveDemandProfile();
+	void RecordPoolDemand(const ABasePool* Pool);
+	// Profiled count for a class prewarmed by a configured pool, 0 if the profile does not have it
+	int32 TakeProfiledPreWarmCount(const UClass* Class);
+	void PreWarmProfiledClasses();
+	void OnProfiledClassesLoaded();
 
 	static void SetActorTransform(const FTransform& SpawnTransform, ESpawnActorScaleMethod TransformScaleMethod, AActor* SpawnedActor);
 private:
@@ -62,6 +265,93 @@ private:
 
 	UPROPERTY()
 	TArray<ABasePool*> ClientPools;
+
+	// Resolved pool per requested class, only invalidated when pools register or unregister
+	TMap<TObjectKey<UClass>, ABasePool*> ResolvedPoolCache;
+
+	// Pool owning each pooled object, recorded when the object is acquired or first resolved
+	TMap<TObjectKey<UObject>, ABasePool*> ObjectOwningPools;
+	// Size ObjectOwningPools has to reach before it is pruned again on tick, doubles with the live entries
+	int32 ObjectOwningPoolsPruneThreshold = 256;
+
+	TMap<TObjectKey<UClass>, FPoolInterfaceClassInfo> InterfaceClassInfoCache;
+
+	struct FPoolPreWarmTask
+	{
+		TWeakObjectPtr<ABasePool> Pool;
+		TSubclassOf<UObject> Class;
+		int32 Remaining = 0;
+		int32 Priority = 0;
+		bool bTrackProgress = true;
+	};
+	// Sorted by priority, highest first
+	TArray<FPoolPreWarmTask> PreWarmTasks;
+	int32 PreWarmQueuedCount = 0;
+	int32 PreWarmCompletedCount = 0;
+	bool bPoolsInitialized = false;
+	bool bPreWarmCompletedBroadcast = false;
+
+	// Configured pools waiting for their pool and preallocation classes to stream in
+	struct FPendingPoolLoad
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		FPoolsToSpawn PoolToSpawn;
+	};
+	TMap<int32, FPendingPoolLoad> PendingPoolLoads;
+	int32 NextPoolLoadId = 0;
+
+	// Requests waiting for a full pool to have room, served in order
+	struct FQueuedPoolRequest
+	{
+		TWeakObjectPtr<ABasePool> Pool;
+		TSubclassOf<UObject> Class;
+		TWeakObjectPtr<AActor> Owner;
+		TFunction<void(UObject*)> OnAcquired;
+		bool bDeferred = false;
+	};
+	TArray<FQueuedPoolRequest> QueuedRequests;
+
+	// Activations waiting for frame budget, keyed by object. The serial tells the live queue entry apart from cancelled ones
+	struct FPendingActivation
+	{
+		FTransform Transform;
+		uint32 Serial = 0;
+	};
+	TMap<TObjectKey<UObject>, FPendingActivation> PendingActivations;
+
+	// One FIFO per non critical priority, entries are skipped instead of removed when their activation is cancelled
+	struct FPendingActivationQueue
+	{
+		TArray<TPair<TWeakObjectPtr<UObject>, uint32>> Entries;
+		int32 Head = 0;
+	};
+	FPendingActivationQueue PendingActivationQueues[static_cast<int32>(EPoolActivationPriority::Low)];
+	uint32 NextPendingActivationSerial = 1;
+
+	struct FPendingActorNetUpdate
+	{
+		TWeakObjectPtr<AActor> Actor;
+		ENetDormancy Dormancy = DORM_Awake;
+	};
+	TMap<TObjectKey<AActor>, FPendingActorNetUpdate> PendingActorNetUpdates;
+	TArray<TWeakObjectPtr<ABasePool>> PendingPoolNetUpdates;
+	FPoolNetUpdateStats NetUpdateStats;
+
+	// Empty when demand profiles are not recorded for this world
+	FString DemandProfilePath;
+	TMap<FSoftClassPath, float> ProfiledHighWaterMarks;
+	// Profiled classes not prewarmed yet, the ones without a configured pool wait for every configured pool to load
+	TMap<FSoftClassPath, int32> PendingProfilePreWarms;
+	// Demand of the pools gone so far this session
+	TMap<FSoftClassPath, FPoolClassDemandProfile> SessionDemand;
+
+	TWeakObjectPtr<ABasePool> DefaultActorPool;
+	TWeakObjectPtr<ABasePool> DefaultObjectPool;
+
+	// Set by the engine memory trim and out of memory delegates, which are not guaranteed to fire on the game thread
+	std::atomic<bool> bMemoryTrimRequested = false;
+	FDelegateHandle MemoryTrimHandle;
+	FDelegateHandle OutOfMemoryHandle;
 };
 
 template <class T>
@@ -69,21 +359,19 @@ T* UPoolSubsystem::RequestPoolObject(TSubclassOf<UObject> Class, AActor* Owner,
 {
 	if (ABasePool* Pool = FindPool(Class))
 	{
-		UObject* SpawnedPoolObject = Pool->PreSpawnPoolObject(Class, Owner);
-		bool bImplementsInterface = SpawnedPoolObject && SpawnedPoolObject->GetClass()->ImplementsInterface(UPoolInterface::StaticClass());
-		
-		if (bImplementsInterface)
+		UObject* SpawnedPoolObject = Pool->AcquirePoolObject(Class, Owner);
+		if (!SpawnedPoolObject)
 		{
-			IPoolInterface::Execute_OnPoolObjectContruct(SpawnedPoolObject);
+			return nullptr;
 		}
 		
+		ObjectOwningPools.Add(SpawnedPoolObject, Pool);
+		NotifyPoolObjectConstruct(SpawnedPoolObject);
+		
 		if (!bDeferred)
 		{
 			Pool->FinishSpawningPoolObject(SpawnedPoolObject, FTransform::Identity);
-			if (bImplementsInterface)
-			{
-				IPoolInterface::Execute_OnPoolObjectActivate(SpawnedPoolObject);
-			}
+			NotifyPoolObjectActivate(SpawnedPoolObject);
 		}
 		
 		return Cast<T>(SpawnedPoolObject);
@@ -102,18 +390,28 @@ T* UPoolSubsystem::FinishSpawningPoolObject(UObject* Target, const FTransform& T
 		return nullptr;
 	}
 	
-	if (ABasePool* Pool = FindPool(Target->GetClass()))
+	// Objects requested through the subsystem already know their pool, anything else is resolved by class
+	ABasePool* Pool = FindPool(Target);
+	if (!Pool)
+	{
+		Pool = FindPool(Target->GetClass());
+	}
+	
+	if (Pool)
 	{
 		Pool->FinishSpawningPoolObject(Target, Transform);
-
-		bool bImplementsInterface = Target->GetClass()->ImplementsInterface(UPoolInterface::StaticClass());
-		if (bImplementsInterface)
-		{
-			IPoolInterface::Execute_OnPoolObjectActivate(Target);
-		}
+		NotifyPoolObjectActivate(Target);
 		
 		return Cast<T>(Target);
 	}
 
 	return nullptr;
 }
+
+template <class T>
+TPoolActiveObjectsRange<T> UPoolSubsystem::GetActivePoolObjects(TSubclassOf<T> Class)
+{
+	FPoolActiveObjectsSegments Segments;
+	GetActiveObjectSegments(Class.Get(), Segments);
+	return TPoolActiveObjectsRange<T>(MoveTemp(Segments));
+}
@@ -8,6 +8,15 @@
 
 class ABasePool;
 
+UENUM()
+enum class EPoolLoadingFallback : uint8
+{
+	// Requests are served by the generic actor/object pools until the dedicated pool finished loading
+	GenericPool,
+	// Block on the pending pool loads the first time a class would fall back to a generic pool
+	FlushLoading,
+};
+
 USTRUCT(Blueprintable)
 struct FPoolsToSpawn
 {
@@ -25,6 +34,10 @@ struct FPoolsToSpawn
 	// how many objects should we create upfront on this pool
 	UPROPERTY(EditAnywhere, Category="Object Pooling")
 	int32 PreAllocationNumber = 0;
+
+	// pools with higher priority are prewarmed first when prewarming is time sliced
+	UPROPERTY(EditAnywhere, Category="Object Pooling")
+	int32 PreWarmPriority = 0;
 };
 
 UCLASS(config = Game, defaultconfig, meta = (DisplayName = "Object Pooling Settings"))
@@ -40,4 +53,49 @@ public:
 
 	UPROPERTY(config, EditAnywhere, Category = "Object Pooling")
 	TArray<FPoolsToSpawn> Pools;
+
+	// Stream pool and preallocation classes in instead of loading them synchronously on world begin play
+	UPROPERTY(config, EditAnywhere, Category = "Object Pooling")
+	bool bAsyncLoadPoolClasses = true;
+
+	// What to do with requests whose dedicated pool is still loading
+	UPROPERTY(config, EditAnywhere, Category = "Object Pooling", meta = (EditCondition = "bAsyncLoadPoolClasses"))
+	EPoolLoadingFallback PendingPoolFallback = EPoolLoadingFallback::GenericPool;
+
+	// Milliseconds per frame spent creating preallocated objects, 0 prewarms every pool in the frame they are spawned
+	UPROPERTY(config, EditAnywhere, Category = "Object Pooling", meta = (ClampMin = "0.0", Units = "ms"))
+	float PreWarmFrameBudgetMs = 0.f;
+
+	/* Milliseconds per frame spent creating the objects pools grow at runtime with bAdaptivePreWarm, on top of PreWarmFrameBudgetMs.
+	 * At least one object is created per frame */
+	UPROPERTY(config, EditAnywhere, Category = "Object Pooling", meta = (ClampMin = "0.01", Units = "ms"))
+	float AdaptivePreWarmFrameBudgetMs = 0.5f;
+
+	/* Saves how many objects of each class were active at once on every map under Saved/PoolProfiles when the world ends,
+	 * and prewarms that many on its next load. PreAllocationNumber still applies when it is higher */
+	UPROPERTY(config, EditAnywhere, Category = "Object Pooling")
+	bool bUseDemandProfiles = false;
+
+	/* Weight of the last session in the saved high water marks, lower values remember older sessions for longer.
+	 * Sessions where requests found no free object always raise the mark to their peak */
+	UPROPERTY(config, EditAnywhere, Category = "Object Pooling", meta = (EditCondition = "bUseDemandProfiles", ClampMin = "0.05", ClampMax = "1.0"))
+	float DemandProfileSessionWeight = 0.3f;
+
+	// Milliseconds per frame spent activating objects requested with a non critical priority, 0 activates every request right away
+	UPROPERTY(config, EditAnywhere, Category = "Object Pooling", meta = (ClampMin = "0.0", Units = "ms"))
+	float ActivationFrameBudgetMs = 0.f;
+
+	/* Game feature plugins whose classes get their properties reset, cooked builds read them from here instead of scanning Plugins/GameFeatures.
+	 * Refreshed automatically when a cook starts, or on demand with Refresh Game Feature Names */
+	UPROPERTY(config, VisibleAnywhere, Category = "Object Pooling")
+	TArray<FString> GameFeatureNames;
+
+	// Finds the game feature plugin folders on disk, not meant to be used in cooked builds
+	static TArray<FString> ScanGameFeatureNames();
+
+#if WITH_EDITOR
+	// Bakes the current game feature plugins into the config so cooked builds can use them
+	UFUNCTION(CallInEditor, Category = "Object Pooling")
+	void RefreshGameFeatureNames();
+#endif
 };
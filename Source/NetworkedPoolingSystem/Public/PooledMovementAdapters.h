@@ -0,0 +1,47 @@
+// Copyright JOSEUEM, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UMovementComponent;
+
+/**
+ * Resets and reactivates one movement component type when its pooled actor is returned and reused.
+ * Adapters handle child classes of their movement component class too, unless a more derived adapter is registered.
+ */
+class NETWORKEDPOOLINGSYSTEM_API IPooledMovementAdapter
+{
+public:
+	virtual ~IPooledMovementAdapter() = default;
+
+	virtual UClass* GetMovementComponentClass() const = 0;
+
+	// Called when the actor returns to the pool, after its components have been deactivated
+	virtual void ResetMovement(UMovementComponent* MovementComponent, AActor* Actor) const {}
+
+	// Called when the actor is reused, once it has its spawn transform and its components are active
+	virtual void ReactivateMovement(UMovementComponent* MovementComponent, AActor* Actor) const = 0;
+};
+
+/**
+ * Movement adapters known by the actor pools. Projectile, rotating, interp to and character movement are registered by default,
+ * custom adapters should be registered on module startup, before any pool resolves the classes using them.
+ */
+class NETWORKEDPOOLINGSYSTEM_API FPooledMovementAdapterRegistry
+{
+public:
+	static FPooledMovementAdapterRegistry& Get();
+
+	void RegisterAdapter(const TSharedRef<IPooledMovementAdapter>& Adapter);
+	void UnregisterAdapter(const TSharedRef<IPooledMovementAdapter>& Adapter);
+
+	// Most derived adapter handling this movement component class, nullptr if there is none
+	TSharedPtr<IPooledMovementAdapter> FindAdapter(const UClass* MovementComponentClass) const;
+
+private:
+	FPooledMovementAdapterRegistry();
+
+	TArray<TSharedRef<IPooledMovementAdapter>> Adapters;
+};
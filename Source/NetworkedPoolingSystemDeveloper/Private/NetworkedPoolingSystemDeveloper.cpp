@@ -1,18 +1,28 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "NetworkedPoolingSystemDeveloper.h"
+#include "PoolSystemSettings.h"
+#include "GameDelegates.h"
 
 #define LOCTEXT_NAMESPACE "FNetworkedPoolingSystemEditorModule"
 
 void FNetworkedPoolingSystemDeveloperModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+	// Bake game feature names into the config right before cooking so cooked builds get an up to date list,
+	// instead of touching DefaultGame.ini on every editor launch
+	ModifyCookDelegateHandle = FGameDelegates::Get().GetModifyCookDelegate().AddLambda([](TArrayView<const ITargetPlatform* const>, TArray<FName>&, TArray<FName>&)
+	{
+		GetMutableDefault<UPoolSystemSettings>()->RefreshGameFeatureNames();
+	});
 }
 
 void FNetworkedPoolingSystemDeveloperModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FGameDelegates::Get().GetModifyCookDelegate().Remove(ModifyCookDelegateHandle);
 }
 
 #undef LOCTEXT_NAMESPACE